@@ -0,0 +1,48 @@
+#pragma once
+
+#include <vector>
+#include <cmath>
+#include <limits>
+
+#include "graph.h"
+
+// ---------------- Geometric A* heuristic ----------------
+// Map coordinates are not in the same unit as edge costs, so the straight
+// line is scaled by the smallest cost/length ratio over all edges. With that
+// factor no edge is ever shorter than the heuristic says, which makes the
+// potential consistent and A* exact. `edgeCosts` is indexed by EdgeId.
+inline double calibrateEuclideanScale(const std::vector<Node>& nodes, const CsrGraph& g,
+                                      const std::vector<double>& edgeCosts){
+    double scale = std::numeric_limits<double>::infinity();
+    for (CsrGraph::EdgeId e=0; e<g.numEdges(); ++e){
+        const Node &a = nodes[g.edgeTail(e)], &b = nodes[g.edgeHead(e)];
+        double len = std::hypot((double)a.x-b.x, (double)a.y-b.y);
+        if (len > 0.0) scale = std::min(scale, edgeCosts[e] / len);
+    }
+    if (!std::isfinite(scale)) return 0.0;
+    return scale * (1.0 - 1e-9); // keep rounding from breaking consistency
+}
+
+// Calibrated against the graph's own weights.
+inline double calibrateEuclideanScale(const std::vector<Node>& nodes, const CsrGraph& g){
+    std::vector<double> weights(g.numEdges());
+    for (CsrGraph::EdgeId e=0; e<g.numEdges(); ++e) weights[e] = g.edgeWeight(e);
+    return calibrateEuclideanScale(nodes, g, weights);
+}
+
+// h(v) = scale * |v - target|
+class EuclideanPotential {
+public:
+    EuclideanPotential(const std::vector<Node>& nodes_, double scale_, int target)
+        : nodes(&nodes_), scale(scale_), tx(nodes_[target].x), ty(nodes_[target].y) {}
+
+    double operator()(int v) const {
+        const Node& n = (*nodes)[v];
+        return scale * std::hypot((double)n.x-tx, (double)n.y-ty);
+    }
+
+private:
+    const std::vector<Node>* nodes;
+    double scale;
+    double tx, ty;
+};
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+
+#include "dijkstra.h"
+
+// ---------------- Bidirectional Dijkstra / A* ----------------
+// A forward search from the source and a backward search from the target,
+// each with its own QueryContext, grow until their frontiers prove that the
+// best meeting point found so far cannot be improved.
+
+struct BidirectionalContext {
+    QueryContext forward, backward;
+};
+
+inline BidirectionalContext& threadBidirectionalContext(){
+    thread_local BidirectionalContext ctx;
+    return ctx;
+}
+
+// Averaged potentials for bidirectional A*: p_f(v) = (h_t(v) - h_s(v)) / 2 and
+// p_b = -p_f. Both stay consistent and, unlike plain h_t/h_s, agree on the
+// reduced cost of every edge, which keeps the simple stopping rule valid.
+template<class Potential>
+class AveragedPotential {
+public:
+    AveragedPotential(Potential toTarget_, Potential toSource_, bool backward_)
+        : toTarget(std::move(toTarget_)), toSource(std::move(toSource_)), sign(backward_ ? -0.5 : 0.5) {}
+
+    double operator()(int v) const { return sign * (toTarget(v) - toSource(v)); }
+
+private:
+    Potential toTarget, toSource;
+    double sign;
+};
+
+// Result of a bidirectional query; `meet` is the node where both halves join.
+struct BidirectionalResult {
+    double distance = QueryContext::kInf;
+    int meet = -1;
+};
+
+// `forwardGraph` is searched from source, `backwardGraph` (the reverse graph,
+// or the same one when it is undirected) from target. Keys are dist + pot;
+// the search stops once topF + topB >= mu, the best s-t length seen.
+template<class Graph, class ForwardPot, class BackwardPot>
+BidirectionalResult bidirectionalSearch(const Graph& forwardGraph, const Graph& backwardGraph,
+                                        int source, int target, BidirectionalContext& ctx,
+                                        const ForwardPot& potF, const BackwardPot& potB){
+    QueryContext& F = ctx.forward;
+    QueryContext& B = ctx.backward;
+    F.reset(forwardGraph.numNodes());
+    B.reset(backwardGraph.numNodes());
+
+    BidirectionalResult best;
+    F.setLabel(source, 0.0, -1); F.push(potF(source), source);
+    B.setLabel(target, 0.0, -1); B.push(potB(target), target);
+    if (source == target){ best.distance = 0.0; best.meet = source; return best; }
+
+    auto step = [&](const Graph& g, QueryContext& self, const QueryContext& other, auto& pot){
+        auto [key, u] = self.pop();
+        const double d = self.dist(u);
+        if (key > d + pot(u)) return; // stale entry
+        ++self.stats.settled;
+        g.forEachArc(u, [&](uint32_t v, double w){
+            ++self.stats.relaxed;
+            double nd = d + w;
+            if (nd < self.dist((int)v)){
+                self.setLabel((int)v, nd, u);
+                self.push(nd + pot((int)v), (int)v);
+                double through = nd + other.dist((int)v);
+                if (through < best.distance){ best.distance = through; best.meet = (int)v; }
+            }
+        });
+    };
+
+    while (!F.empty() && !B.empty()){
+        if (F.topKey() + B.topKey() >= best.distance) break;
+        if (F.topKey() <= B.topKey()) step(forwardGraph, F, B, potF);
+        else                          step(backwardGraph, B, F, potB);
+    }
+    return best;
+}
+
+// Joins the two half-paths at `meet`: source..meet from the forward tree,
+// meet..target from the backward tree.
+inline std::vector<int> bidirectionalPath(const BidirectionalContext& ctx, int meet){
+    std::vector<int> path = ctx.forward.pathTo(meet);
+    if (path.empty()) return path;
+    for (int cur=ctx.backward.parent(meet); cur!=-1; cur=ctx.backward.parent(cur)) path.push_back(cur);
+    return path;
+}
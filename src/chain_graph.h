@@ -0,0 +1,229 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cmath>
+
+#include "graph.h"
+
+// ---------------- Degree-2 chain compression ----------------
+// Routing graph without the nodes that only continue a road: every maximal
+// chain of degree-2 nodes between two other nodes becomes one arc weighing
+// the whole chain, so a search settles only junctions and dead ends. The
+// chain's nodes are kept in order with their distance from the first end,
+// which is enough to expand a route back to every node for drawing and
+// measuring.
+//
+// Node ids are those of the CsrGraph it was built from, so potentials and
+// landmark tables indexed by node keep working; chain nodes simply have no
+// arcs. A query whose start or target lies inside a chain goes through
+// view(), which snaps it to the chain: the snapped node gets arcs to both
+// chain ends (and to the other endpoint if both lie on one chain), and the
+// chain ends get arcs back to it.
+class ChainGraph {
+public:
+    using NodeId = CsrGraph::NodeId;
+    static constexpr uint32_t kNone = ~0u;
+
+    ChainGraph() = default;
+
+    // Interior nodes have exactly two arcs of different edges; a ring of
+    // them with no junction keeps its first node as one.
+    static ChainGraph build(const CsrGraph& g){
+        ChainGraph c;
+        const uint32_t n = g.numNodes();
+        std::vector<uint8_t> junction(n);
+        for (NodeId v=0; v<n; ++v){
+            const CsrGraph::ArcId a = g.arcBegin(v);
+            junction[v] = !(g.arcEnd(v) - a == 2 && g.arcEdge(a) != g.arcEdge(a+1));
+        }
+        c.chainOf.assign(n, kNone);
+        c.slotOf.assign(n, kNone);
+        c.chainBegin.push_back(0);
+
+        struct Arc { NodeId from, to; double weight; uint32_t chain; };
+        std::vector<Arc> arcs;
+        // Follows the chain that leaves junction `a` through arc `first`.
+        auto walk = [&](NodeId a, CsrGraph::ArcId first){
+            const uint32_t chain = (uint32_t)c.chainLengths.size();
+            CsrGraph::EdgeId via = g.arcEdge(first);
+            NodeId cur = g.arcTarget(first);
+            double d = g.arcWeight(first);
+            while (!junction[cur]){
+                c.chainOf[cur] = chain;
+                c.slotOf[cur] = (uint32_t)c.chainNodes.size();
+                c.chainNodes.push_back(cur);
+                c.chainDistances.push_back(d);
+                const CsrGraph::ArcId a0 = g.arcBegin(cur);
+                const CsrGraph::ArcId next = g.arcEdge(a0) == via ? a0 + 1 : a0;
+                via = g.arcEdge(next);
+                d += g.arcWeight(next);
+                cur = g.arcTarget(next);
+            }
+            c.chainEnds.push_back(a);
+            c.chainEnds.push_back(cur);
+            c.chainLengths.push_back(d);
+            c.chainBegin.push_back((uint32_t)c.chainNodes.size());
+            if (a != cur){ arcs.push_back({a, cur, d, chain}); arcs.push_back({cur, a, d, chain}); }
+        };
+        for (NodeId u=0; u<n; ++u){
+            if (!junction[u]) continue;
+            for (CsrGraph::ArcId a=g.arcBegin(u); a<g.arcEnd(u); ++a){
+                const NodeId v = g.arcTarget(a);
+                if (junction[v]){ if (v != u) arcs.push_back({u, v, g.arcWeight(a), kNone}); }
+                else if (c.chainOf[v] == kNone) walk(u, a);
+            }
+        }
+        for (NodeId v=0; v<n; ++v){
+            if (junction[v] || c.chainOf[v] != kNone) continue;
+            junction[v] = 1;
+            walk(v, g.arcBegin(v));
+        }
+        c.numJunctions = n - (uint32_t)c.chainNodes.size();
+
+        c.offsets.assign(n + 1, 0);
+        for (const Arc& a : arcs) ++c.offsets[a.from + 1];
+        for (uint32_t i=0; i<n; ++i) c.offsets[i+1] += c.offsets[i];
+        c.targets.resize(arcs.size());
+        c.weights.resize(arcs.size());
+        c.arcChains.resize(arcs.size());
+        std::vector<uint32_t> fill(c.offsets.begin(), c.offsets.end() - 1);
+        for (const Arc& a : arcs){
+            const uint32_t i = fill[a.from]++;
+            c.targets[i] = a.to; c.weights[i] = a.weight; c.arcChains[i] = a.chain;
+        }
+        return c;
+    }
+
+    uint32_t numNodes() const { return offsets.empty() ? 0 : (uint32_t)offsets.size() - 1; }
+    uint32_t numJunctionNodes() const { return numJunctions; }
+    uint32_t numChains() const { return (uint32_t)chainLengths.size(); }
+    uint32_t numArcs() const { return (uint32_t)targets.size(); }
+    bool empty() const { return offsets.empty(); }
+    size_t sizeBytes() const {
+        return offsets.size()*4 + targets.size()*4 + weights.size()*8 + arcChains.size()*4 + chainEnds.size()*4 +
+               chainBegin.size()*4 + chainNodes.size()*4 + chainDistances.size()*8 + chainLengths.size()*8 +
+               chainOf.size()*4 + slotOf.size()*4;
+    }
+
+    // Junction arcs only; chain nodes have none (use a view to start there).
+    template<class F> void forEachArc(NodeId u, F&& f) const {
+        for (uint32_t a=offsets[u]; a<offsets[u+1]; ++a) f(targets[a], weights[a]);
+    }
+
+    // ---- queries ----
+    // The graph seen by one query from `source` to `target`: junction arcs
+    // plus the arcs that snap either endpoint to its chain. Both directions
+    // are present, so it serves bidirectional searches too.
+    class View {
+    public:
+        uint32_t numNodes() const { return chains->numNodes(); }
+
+        template<class F> void forEachArc(NodeId u, F&& f) const {
+            for (int i=0; i<2; ++i){
+                if (u != ends[i].node || ends[i].chain == kNone) continue;
+                const End& e = ends[i], &other = ends[1-i];
+                f(chains->chainEnds[2*e.chain], e.fromFirst);
+                f(chains->chainEnds[2*e.chain+1], e.toSecond);
+                if (other.chain == e.chain && other.node != e.node) f(other.node, std::abs(other.fromFirst - e.fromFirst));
+                return;
+            }
+            chains->forEachArc(u, f);
+            for (const End& e : ends){
+                if (e.chain == kNone) continue;
+                if (chains->chainEnds[2*e.chain] == u) f(e.node, e.fromFirst);
+                if (chains->chainEnds[2*e.chain+1] == u) f(e.node, e.toSecond);
+            }
+        }
+
+        // Puts the chain nodes back into a route found on this view.
+        std::vector<int> expand(const std::vector<int>& route) const {
+            std::vector<int> out;
+            if (route.empty()) return out;
+            out.push_back(route[0]);
+            for (size_t i=1; i<route.size(); ++i){
+                const NodeId x = (NodeId)route[i-1], y = (NodeId)route[i];
+                const End* ex = endAt(x);
+                const End* ey = endAt(y);
+                if (ex && ey) walkChain(ex->chain, ex->index, ey->index, out);
+                else if (ex) walkChain(ex->chain, ex->index, endPosition(*ex, y), out);
+                else if (ey) walkChain(ey->chain, endPosition(*ey, x), ey->index, out);
+                else {
+                    // the lightest arc x->y is the one the search relaxed
+                    uint32_t best = kNone;
+                    for (uint32_t a=chains->offsets[x]; a<chains->offsets[x+1]; ++a)
+                        if (chains->targets[a] == y && (best == kNone || chains->weights[a] < chains->weights[best])) best = a;
+                    const uint32_t c = best == kNone ? kNone : chains->arcChains[best];
+                    if (c != kNone){
+                        const int last = (int)(chains->chainBegin[c+1] - chains->chainBegin[c]);
+                        if (chains->chainEnds[2*c] == x) walkChain(c, -1, last, out);
+                        else walkChain(c, last, -1, out);
+                    }
+                }
+                out.push_back((int)y);
+            }
+            return out;
+        }
+
+    private:
+        friend class ChainGraph;
+        struct End {
+            NodeId node = kNone;
+            uint32_t chain = kNone;  // kNone: a junction, no snapping needed
+            int index = 0;           // position among the chain's nodes
+            double fromFirst = 0.0, toSecond = 0.0;
+        };
+
+        const End* endAt(NodeId v) const {
+            for (const End& e : ends) if (e.node == v && e.chain != kNone) return &e;
+            return nullptr;
+        }
+        // Position of chain end `v` seen from the snapped node `e`: -1 for
+        // the first end, the chain length for the second (the nearer one if
+        // the chain is a loop).
+        int endPosition(const End& e, NodeId v) const {
+            const int last = (int)(chains->chainBegin[e.chain+1] - chains->chainBegin[e.chain]);
+            const NodeId first = chains->chainEnds[2*e.chain], second = chains->chainEnds[2*e.chain+1];
+            if (v == first && (v != second || e.fromFirst <= e.toSecond)) return -1;
+            return last;
+        }
+        // Appends the chain's nodes strictly between positions from and to.
+        void walkChain(uint32_t c, int from, int to, std::vector<int>& out) const {
+            const NodeId* nodes = chains->chainNodes.data() + chains->chainBegin[c];
+            if (from < to) for (int i=from+1; i<to; ++i) out.push_back((int)nodes[i]);
+            else for (int i=from-1; i>to; --i) out.push_back((int)nodes[i]);
+        }
+
+        const ChainGraph* chains = nullptr;
+        End ends[2];
+    };
+
+    View view(NodeId source, NodeId target) const {
+        View v;
+        v.chains = this;
+        for (int i=0; i<2; ++i){
+            View::End& e = v.ends[i];
+            e.node = i == 0 ? source : target;
+            e.chain = chainOf[e.node];
+            if (e.chain == kNone) continue;
+            e.index = (int)(slotOf[e.node] - chainBegin[e.chain]);
+            e.fromFirst = chainDistances[slotOf[e.node]];
+            e.toSecond = chainLengths[e.chain] - e.fromFirst;
+        }
+        return v;
+    }
+
+private:
+    std::vector<uint32_t> offsets;      // numNodes+1, junction arcs of u are [offsets[u], offsets[u+1])
+    std::vector<NodeId>   targets;
+    std::vector<double>   weights;
+    std::vector<uint32_t> arcChains;    // chain an arc stands for, kNone for an original edge
+    std::vector<NodeId>   chainEnds;    // first/second junction per chain (equal for a loop)
+    std::vector<uint32_t> chainBegin;   // nodes of chain c are chainNodes[chainBegin[c], chainBegin[c+1])
+    std::vector<NodeId>   chainNodes;   // in order from the first end
+    std::vector<double>   chainDistances; // from the first end, per chain node
+    std::vector<double>   chainLengths;
+    std::vector<uint32_t> chainOf;      // per node: its chain, kNone for junctions
+    std::vector<uint32_t> slotOf;       // per node: index into chainNodes
+    uint32_t numJunctions = 0;
+};
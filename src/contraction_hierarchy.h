@@ -0,0 +1,260 @@
+#pragma once
+
+#include <vector>
+#include <queue>
+#include <utility>
+#include <cstdint>
+#include <algorithm>
+#include <functional>
+
+#include "graph.h"
+#include "dijkstra.h"
+#include "bidirectional.h"
+
+// ---------------- Contraction Hierarchies ----------------
+// Nodes are contracted one by one in order of importance (edge difference,
+// lazily re-evaluated). Removing a node adds a shortcut between two of its
+// neighbours unless a local witness search finds a path that is no longer.
+// Queries then only ever walk "upward" (towards more important nodes) from
+// both ends and meet at the top, which touches a tiny part of the graph.
+// Every upward arc remembers the node it bypasses so paths can be unpacked
+// back into original node ids.
+class ContractionHierarchy {
+public:
+    using NodeId = CsrGraph::NodeId;
+    static constexpr uint32_t kNoMiddle = CsrGraph::kInvalid;
+
+    // Witness searches give up (and keep the shortcut) after this many nodes.
+    // Priority estimates only need a rough count, so they search less.
+    static constexpr uint32_t kWitnessSettleLimit  = 500;
+    static constexpr uint32_t kEstimateSettleLimit = 40;
+
+    ContractionHierarchy() = default;
+
+    static ContractionHierarchy build(const CsrGraph& g){
+        ContractionHierarchy ch;
+        const uint32_t n = g.numNodes();
+        std::vector<uint32_t> ranks(n, 0);
+
+        // Mutable copy of the topology, one (min-weight) arc per neighbour.
+        std::vector<std::vector<DynArc>> adj(n);
+        for (NodeId u=0; u<n; ++u){
+            for (auto a=g.arcBegin(u); a<g.arcEnd(u); ++a){
+                NodeId v = g.arcTarget(a);
+                if (v != u) addOrLower(adj[u], v, g.arcWeight(a), kNoMiddle);
+            }
+        }
+
+        std::vector<char> contracted(n, 0);
+        std::vector<int>  deletedNeighbours(n, 0);
+        std::vector<Shortcut> shortcuts;
+        QueryContext witnessCtx;
+
+        auto priority = [&](NodeId v, uint32_t settleLimit){
+            shortcuts.clear();
+            findShortcuts(adj, contracted, v, settleLimit, witnessCtx, shortcuts);
+            int degree = 0;
+            for (const auto& a : adj[v]) if (!contracted[a.to]) ++degree;
+            // Edge difference dominates; deleted neighbours spread contraction
+            // evenly over the graph so no region is left for the very end.
+            return 4*((int)shortcuts.size() - degree) + deletedNeighbours[v];
+        };
+
+        using Entry = std::pair<int, NodeId>;
+        std::priority_queue<Entry, std::vector<Entry>, std::greater<>> order;
+        for (NodeId v=0; v<n; ++v) order.push({priority(v, kEstimateSettleLimit), v});
+
+        // Upward arcs of each node, collected as it is contracted.
+        std::vector<std::vector<DynArc>> up(n);
+        uint32_t nextRank = 0;
+        while (!order.empty()){
+            auto [prio, v] = order.top(); order.pop();
+            if (contracted[v]) continue;
+            int fresh = priority(v, kEstimateSettleLimit);
+            if (!order.empty() && fresh > order.top().first){ order.push({fresh, v}); continue; }
+
+            priority(v, kWitnessSettleLimit); // leaves v's final shortcuts in `shortcuts`
+            for (const auto& sc : shortcuts){
+                addOrLower(adj[sc.from], sc.to, sc.weight, v);
+                addOrLower(adj[sc.to], sc.from, sc.weight, v);
+            }
+            ch.numShortcuts += (uint32_t)shortcuts.size();
+
+            contracted[v] = 1;
+            ranks[v] = nextRank++;
+            for (const auto& a : adj[v]){
+                if (contracted[a.to]) continue;
+                up[v].push_back(a);
+                ++deletedNeighbours[a.to];
+                auto& back = adj[a.to];
+                back.erase(std::remove_if(back.begin(), back.end(),
+                                          [&](const DynArc& b){ return b.to == v; }), back.end());
+                order.push({priority(a.to, kEstimateSettleLimit), a.to});
+            }
+            adj[v].clear(); adj[v].shrink_to_fit();
+        }
+
+        std::vector<uint32_t> offsets(n+1, 0);
+        for (NodeId v=0; v<n; ++v) offsets[v+1] = offsets[v] + (uint32_t)up[v].size();
+        std::vector<NodeId> targets;
+        std::vector<double> weights;
+        std::vector<uint32_t> middles;
+        targets.reserve(offsets[n]);
+        weights.reserve(offsets[n]);
+        middles.reserve(offsets[n]);
+        for (NodeId v=0; v<n; ++v){
+            for (const auto& a : up[v]){
+                targets.push_back(a.to); weights.push_back(a.weight); middles.push_back(a.middle);
+            }
+        }
+        ch.ranks = std::move(ranks);
+        ch.offsets = std::move(offsets);
+        ch.targets = std::move(targets);
+        ch.weights = std::move(weights);
+        ch.middles = std::move(middles);
+        return ch;
+    }
+
+    bool empty() const { return ranks.empty(); }
+    uint32_t numNodes() const { return (uint32_t)ranks.size(); }
+    uint32_t numUpwardArcs() const { return (uint32_t)targets.size(); }
+    uint32_t shortcutCount() const { return numShortcuts; }
+    uint32_t rank(NodeId v) const { return ranks[v]; }
+
+    // Upward arcs only; the hierarchy is undirected so one graph serves both
+    // search directions.
+    template<class F> void forEachArc(NodeId u, F&& f) const {
+        for (uint32_t a=offsets[u]; a<offsets[u+1]; ++a) f(targets[a], weights[a]);
+    }
+    template<class F> void forEachUpwardArc(NodeId u, F&& f) const {
+        for (uint32_t a=offsets[u]; a<offsets[u+1]; ++a) f(targets[a], weights[a], middles[a]);
+    }
+
+    // Bidirectional upward search with stall-on-demand.
+    BidirectionalResult query(int source, int target, BidirectionalContext& ctx) const {
+        QueryContext& F = ctx.forward;
+        QueryContext& B = ctx.backward;
+        F.reset(numNodes()); B.reset(numNodes());
+        BidirectionalResult best;
+        F.setLabel(source, 0.0, -1); F.push(0.0, source);
+        B.setLabel(target, 0.0, -1); B.push(0.0, target);
+
+        auto active = [&](const QueryContext& q){ return !q.empty() && q.topKey() < best.distance; };
+        auto step = [&](QueryContext& self, const QueryContext& other){
+            auto [d, u] = self.pop();
+            if (d > self.dist(u)) return; // stale entry
+            ++self.stats.settled;
+            if (other.reached(u) && d + other.dist(u) < best.distance){
+                best.distance = d + other.dist(u); best.meet = u;
+            }
+            // Stall: a higher neighbour already offers a shorter way to u, so
+            // u cannot be on a shortest up-down path from this side.
+            bool stalled = false;
+            forEachArc(u, [&](NodeId x, double w){ if (self.dist((int)x) + w < d) stalled = true; });
+            if (stalled) return;
+            forEachArc(u, [&](NodeId v, double w){
+                ++self.stats.relaxed;
+                double nd = d + w;
+                if (nd < self.dist((int)v)){ self.setLabel((int)v, nd, u); self.push(nd, (int)v); }
+            });
+        };
+
+        while (active(F) || active(B)){
+            bool forward = active(F) && (!active(B) || F.topKey() <= B.topKey());
+            if (forward) step(F, B); else step(B, F);
+        }
+        return best;
+    }
+
+    // Expands the up-down path of the last query into original node ids.
+    std::vector<int> unpackPath(const BidirectionalContext& ctx, int meet) const {
+        std::vector<int> packed = bidirectionalPath(ctx, meet);
+        std::vector<int> path;
+        if (packed.empty()) return path;
+        path.push_back(packed.front());
+        for (size_t i=0; i+1<packed.size(); ++i) unpackArc(packed[i], packed[i+1], path);
+        return path;
+    }
+
+private:
+    struct DynArc { NodeId to; double weight; uint32_t middle; };
+    struct Shortcut { NodeId from, to; double weight; };
+
+    static void addOrLower(std::vector<DynArc>& list, NodeId to, double w, uint32_t middle){
+        for (auto& a : list){
+            if (a.to == to){ if (w < a.weight){ a.weight = w; a.middle = middle; } return; }
+        }
+        list.push_back({to, w, middle});
+    }
+
+    // Shortcuts needed if v were contracted now.
+    static void findShortcuts(const std::vector<std::vector<DynArc>>& adj, const std::vector<char>& contracted,
+                              NodeId v, uint32_t settleLimit, QueryContext& ctx, std::vector<Shortcut>& out){
+        const auto& nb = adj[v];
+        for (size_t i=0; i<nb.size(); ++i){
+            if (contracted[nb[i].to]) continue;
+            // -1 until a pair exists: a via-path through zero-weight edges
+            // weighs 0 and still needs its shortcut.
+            double maxVia = -1.0;
+            for (size_t j=i+1; j<nb.size(); ++j)
+                if (!contracted[nb[j].to]) maxVia = std::max(maxVia, nb[i].weight + nb[j].weight);
+            if (maxVia < 0.0) continue;
+
+            // Local Dijkstra from nb[i] that must not pass through v.
+            const NodeId src = nb[i].to;
+            ctx.reset(adj.size());
+            ctx.setLabel((int)src, 0.0, -1); ctx.push(0.0, (int)src);
+            uint32_t settled = 0;
+            while (!ctx.empty() && settled < settleLimit){
+                auto [d, u] = ctx.pop();
+                if (d > ctx.dist(u)) continue;
+                if (d > maxVia) break;
+                ++settled;
+                bool allWitnessed = true; // every neighbour already has a path <= via v
+                for (size_t j=i+1; j<nb.size() && allWitnessed; ++j){
+                    if (!contracted[nb[j].to] && nb[j].to != src &&
+                        ctx.dist((int)nb[j].to) > nb[i].weight + nb[j].weight) allWitnessed = false;
+                }
+                if (allWitnessed) break;
+                for (const auto& a : adj[u]){
+                    if (a.to == v || contracted[a.to]) continue;
+                    double nd = d + a.weight;
+                    if (nd < ctx.dist((int)a.to)){ ctx.setLabel((int)a.to, nd, u); ctx.push(nd, (int)a.to); }
+                }
+            }
+            for (size_t j=i+1; j<nb.size(); ++j){
+                if (contracted[nb[j].to] || nb[j].to == src) continue;
+                double via = nb[i].weight + nb[j].weight;
+                if (ctx.dist((int)nb[j].to) > via) out.push_back({src, nb[j].to, via});
+            }
+        }
+    }
+
+    // Appends the original nodes of the arc a-b (excluding a) to `path`.
+    void unpackArc(int a, int b, std::vector<int>& path) const {
+        std::vector<std::pair<int,int>> stack{{a, b}};
+        while (!stack.empty()){
+            auto [x, y] = stack.back(); stack.pop_back();
+            uint32_t middle = middleOf((NodeId)x, (NodeId)y);
+            if (middle == kNoMiddle){ path.push_back(y); continue; }
+            stack.push_back({(int)middle, y}); // second half is handled after the first
+            stack.push_back({x, (int)middle});
+        }
+    }
+
+    uint32_t middleOf(NodeId x, NodeId y) const {
+        NodeId lo = ranks[x] < ranks[y] ? x : y;
+        NodeId hi = lo == x ? y : x;
+        for (uint32_t a=offsets[lo]; a<offsets[lo+1]; ++a) if (targets[a] == hi) return middles[a];
+        return kNoMiddle;
+    }
+
+    friend class GraphFile;
+
+    Column<uint32_t> ranks;    // contraction order, higher = more important
+    Column<uint32_t> offsets;  // upward graph in CSR form
+    Column<NodeId>   targets;
+    Column<double>   weights;
+    Column<uint32_t> middles;  // bypassed node for shortcuts, kNoMiddle otherwise
+    uint32_t numShortcuts = 0;
+};
@@ -0,0 +1,346 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+
+#include "graph.h"
+#include "mapped_file.h"
+#include "parallel.h"
+
+// ---------------- CSV / TSV graph loader ----------------
+// Reads the network from two text files:
+//   nodes: id, x, y, name            (ids 0..n-1, each exactly once, any order)
+//   edges: from, to, weight[, speed[, toll]]   (speed/toll empty or 0 = default)
+// Fields are separated by commas, or by tabs if the first line has one. An
+// optional header line (first field not a number), blank lines and lines
+// starting with '#' are skipped; a name may be "quoted" to hold separators.
+//
+// Files are memory-mapped and cut into chunks at line ends, which are parsed
+// in parallel by a hand-written tokenizer. Edges take two passes over the
+// text instead of an intermediate edge list: the first counts rows and node
+// degrees, the second writes every edge into the CSR arrays, which a last
+// pass per node puts in order.
+class CsvGraphLoader {
+public:
+    // On failure returns false, leaves `nodes`/`graph` untouched and says why
+    // (file, line, problem) in `error`.
+    static bool load(const std::string& nodesPath, const std::string& edgesPath,
+                     std::vector<Node>& nodes, CsrGraph& graph, std::string& error){
+        std::vector<Node> loadedNodes;
+        CsrGraph::Parts parts;
+        if (!loadNodes(nodesPath, loadedNodes, error)) return false;
+        if (!loadEdges(edgesPath, (uint32_t)loadedNodes.size(), parts, error)) return false;
+        nodes = std::move(loadedNodes);
+        graph = CsrGraph::fromParts(std::move(parts));
+        return true;
+    }
+
+private:
+    using NodeId = CsrGraph::NodeId;
+    static constexpr size_t kMinChunkBytes = 1u << 16;
+
+    // ---- tokenizer ----
+    struct Cursor {
+        const char* p;
+        const char* end; // end of the line, before '\n' (and any '\r')
+        char sep;
+        const char* problem = nullptr;
+
+        void skipSpaces(){ while (p < end && (*p == ' ' || *p == '\t') && *p != sep) ++p; }
+        bool atEnd(){ skipSpaces(); return p >= end; }
+
+        // Moves past the separator that ends the current field.
+        bool next(){
+            skipSpaces();
+            if (p < end && *p == sep){ ++p; return true; }
+            if (!problem) problem = p >= end ? "too few fields" : "unexpected character";
+            return false;
+        }
+
+        bool number(double& out){
+            skipSpaces();
+            const char* s = p;
+            bool negative = false;
+            if (p < end && (*p == '-' || *p == '+')){ negative = *p == '-'; ++p; }
+            uint64_t mantissa = 0;
+            int exponent = 0, digits = 0;
+            for (; p < end && *p >= '0' && *p <= '9'; ++p, ++digits){
+                if (mantissa < 1000000000000000000ull) mantissa = mantissa*10 + (uint64_t)(*p - '0');
+                else ++exponent; // beyond double precision anyway
+            }
+            if (p < end && *p == '.'){
+                for (++p; p < end && *p >= '0' && *p <= '9'; ++p, ++digits){
+                    if (mantissa < 1000000000000000000ull){ mantissa = mantissa*10 + (uint64_t)(*p - '0'); --exponent; }
+                }
+            }
+            if (digits == 0){ p = s; if (!problem) problem = "expected a number"; return false; }
+            if (p < end && (*p == 'e' || *p == 'E')){
+                ++p;
+                bool negExp = false;
+                if (p < end && (*p == '-' || *p == '+')){ negExp = *p == '-'; ++p; }
+                int e = 0;
+                if (p >= end || *p < '0' || *p > '9'){ if (!problem) problem = "bad exponent"; return false; }
+                for (; p < end && *p >= '0' && *p <= '9'; ++p) if (e < 10000) e = e*10 + (*p - '0');
+                exponent += negExp ? -e : e;
+            }
+            // Exact for the usual short decimals: both operands are exact
+            // doubles and one IEEE division/multiplication rounds correctly.
+            double v = (double)mantissa;
+            if (exponent < 0) v = exponent >= -22 ? v / kPow10[-exponent] : v * std::pow(10.0, exponent);
+            else if (exponent > 0) v = exponent <= 22 ? v * kPow10[exponent] : v * std::pow(10.0, exponent);
+            out = negative ? -v : v;
+            return true;
+        }
+
+        bool index(uint32_t& out){
+            skipSpaces();
+            uint64_t v = 0;
+            const char* s = p;
+            for (; p < end && *p >= '0' && *p <= '9'; ++p){ v = v*10 + (uint64_t)(*p - '0'); if (v > 0xffffffffull) break; }
+            if (p == s || v >= CsrGraph::kInvalid){ if (!problem) problem = "expected a node id"; return false; }
+            out = (uint32_t)v;
+            return true;
+        }
+
+        // Rest of the field as text; "quoted" text may contain separators
+        // and "" for a quote.
+        void text(std::string& out){
+            skipSpaces();
+            out.clear();
+            if (p < end && *p == '"'){
+                for (++p; p < end; ++p){
+                    if (*p != '"'){ out += *p; continue; }
+                    if (p+1 < end && p[1] == '"'){ out += '"'; ++p; continue; }
+                    ++p;
+                    break;
+                }
+                return;
+            }
+            const char* s = p;
+            while (p < end && *p != sep) ++p;
+            const char* e = p;
+            while (e > s && (e[-1] == ' ' || e[-1] == '\t')) --e;
+            out.assign(s, e);
+        }
+    };
+    static constexpr double kPow10[23] = {1e0,1e1,1e2,1e3,1e4,1e5,1e6,1e7,1e8,1e9,1e10,1e11,
+                                          1e12,1e13,1e14,1e15,1e16,1e17,1e18,1e19,1e20,1e21,1e22};
+
+    // ---- files and chunks ----
+    struct Text {
+        MappedFile file;
+        const char* body = nullptr; // first data line (after any header)
+        const char* end = nullptr;
+        char sep = ',';
+        std::vector<const char*> chunkStarts; // chunk c is [starts[c], starts[c+1])
+    };
+
+    static const char* lineEnd(const char* p, const char* end){
+        const char* nl = (const char*)std::memchr(p, '\n', (size_t)(end - p));
+        return nl ? nl : end;
+    }
+    static bool skippable(const char* p, const char* e){
+        while (p < e && (*p == ' ' || *p == '\t' || *p == '\r')) ++p;
+        return p == e || *p == '#';
+    }
+
+    static bool open(const std::string& path, Text& t, std::string& error){
+        if (!t.file.open(path)){ error = path + ": cannot open"; return false; }
+        const char* p = t.file.data();
+        t.end = p + t.file.size();
+        while (p < t.end){
+            const char* e = lineEnd(p, t.end);
+            if (skippable(p, e)){ p = e + (e < t.end); continue; }
+            t.sep = std::memchr(p, '\t', (size_t)(e - p)) ? '\t' : ',';
+            const char* f = p;
+            while (f < e && (*f == ' ' || *f == '\t')) ++f;
+            bool header = f < e && !(*f >= '0' && *f <= '9') && *f != '-' && *f != '+' && *f != '.';
+            if (header) p = e + (e < t.end);
+            break;
+        }
+        t.body = p;
+
+        const size_t bytes = (size_t)(t.end - t.body);
+        const size_t chunks = std::max<size_t>(1, std::min<size_t>((size_t)sharedPool().size() * 4, bytes / kMinChunkBytes));
+        t.chunkStarts.push_back(t.body);
+        for (size_t c=1; c<chunks; ++c){
+            const char* s = std::max(t.body + bytes * c / chunks, t.chunkStarts.back());
+            s = lineEnd(s, t.end);
+            t.chunkStarts.push_back(s + (s < t.end));
+        }
+        t.chunkStarts.push_back(t.end);
+        return true;
+    }
+
+    // f(cursor) for every data line of chunk c; stops at the first false and
+    // returns where that line starts (nullptr if every line was accepted).
+    template<class F>
+    static const char* forEachLine(const Text& t, size_t c, F&& f){
+        for (const char* p = t.chunkStarts[c]; p < t.chunkStarts[c+1]; ){
+            const char* e = lineEnd(p, t.end);
+            const char* e2 = e;
+            if (e2 > p && e2[-1] == '\r') --e2;
+            if (!skippable(p, e2)){
+                Cursor cur{p, e2, t.sep};
+                if (!f(cur)) return p;
+            }
+            p = e + (e < t.end);
+        }
+        return nullptr;
+    }
+
+    static std::string where(const std::string& path, const Text& t, const char* line, const char* problem){
+        size_t number = 1 + (size_t)std::count(t.file.data(), line, '\n');
+        return path + " line " + std::to_string(number) + ": " + (problem ? problem : "bad line");
+    }
+
+    // The first failing line over all chunks, in file order.
+    static bool firstError(const std::string& path, const Text& t, const std::vector<const char*>& lines,
+                           const std::vector<const char*>& problems, std::string& error){
+        for (size_t c=0; c<lines.size(); ++c){
+            if (!lines[c]) continue;
+            error = where(path, t, lines[c], problems[c]);
+            return true;
+        }
+        return false;
+    }
+
+    // ---- nodes ----
+    struct NodeRow { uint32_t id; double x, y; };
+    static bool parseNode(Cursor& cur, NodeRow& row, std::string& name){
+        if (!cur.index(row.id) || !cur.next() || !cur.number(row.x) || !cur.next() || !cur.number(row.y) || !cur.next()) return false;
+        // Stored as float, so a coordinate that only fits a double is rejected too
+        if (!std::isfinite((float)row.x) || !std::isfinite((float)row.y)){ cur.problem = "coordinates must be finite"; return false; }
+        cur.text(name);
+        if (!cur.atEnd()){ cur.problem = "too many fields"; return false; }
+        return true;
+    }
+
+    static bool loadNodes(const std::string& path, std::vector<Node>& nodes, std::string& error){
+        Text t;
+        if (!open(path, t, error)) return false;
+        const size_t chunks = t.chunkStarts.size() - 1;
+        std::vector<size_t> rows(chunks, 0);
+        parallelFor(0, chunks, [&](size_t c){
+            forEachLine(t, c, [&](Cursor&){ ++rows[c]; return true; });
+        }, 1);
+        size_t n = 0;
+        for (size_t r : rows) n += r;
+        if (n >= CsrGraph::kInvalid){ error = path + ": too many nodes"; return false; }
+
+        nodes.assign(n, Node());
+        std::vector<std::atomic<uint8_t>> seen(n);
+        for (auto& s : seen) s.store(0, std::memory_order_relaxed);
+        std::vector<const char*> badLine(chunks, nullptr), problem(chunks, nullptr);
+        parallelFor(0, chunks, [&](size_t c){
+            NodeRow row;
+            std::string name;
+            badLine[c] = forEachLine(t, c, [&](Cursor& cur){
+                bool ok = parseNode(cur, row, name);
+                if (ok && row.id >= n){ cur.problem = "node id beyond the number of nodes"; ok = false; }
+                if (ok && seen[row.id].exchange(1)){ cur.problem = "duplicate node id"; ok = false; }
+                if (!ok){ problem[c] = cur.problem; return false; }
+                nodes[row.id] = Node((float)row.x, (float)row.y, name);
+                return true;
+            });
+        }, 1);
+        return !firstError(path, t, badLine, problem, error);
+    }
+
+    // ---- edges ----
+    struct EdgeRow { uint32_t from, to; double weight, speed, toll; };
+    static bool parseEdge(Cursor& cur, uint32_t n, EdgeRow& row){
+        row.speed = row.toll = 0.0;
+        if (!cur.index(row.from) || !cur.next() || !cur.index(row.to) || !cur.next() || !cur.number(row.weight)) return false;
+        if (!cur.atEnd()){ // optional speed, then toll; either may be left empty
+            if (!cur.next()) return false;
+            if (!cur.atEnd() && *cur.p != cur.sep && !cur.number(row.speed)) return false;
+            if (!cur.atEnd()){
+                if (!cur.next()) return false;
+                if (!cur.atEnd() && !cur.number(row.toll)) return false;
+                if (!cur.atEnd()){ cur.problem = "too many fields"; return false; }
+            }
+        }
+        if (row.from >= n || row.to >= n){ cur.problem = "edge end is not a node"; return false; }
+        if (!(row.weight >= 0.0) || !std::isfinite(row.weight)){ cur.problem = "weight must be finite and not negative"; return false; }
+        if (row.speed < 0.0 || row.toll < 0.0){ cur.problem = "speed and toll must not be negative"; return false; }
+        return true;
+    }
+
+    static bool loadEdges(const std::string& path, uint32_t n, CsrGraph::Parts& g, std::string& error){
+        Text t;
+        if (!open(path, t, error)) return false;
+        const size_t chunks = t.chunkStarts.size() - 1;
+
+        // Pass 1: validate, count rows per chunk and arcs per node.
+        std::vector<std::atomic<uint32_t>> degree(n);
+        for (auto& d : degree) d.store(0, std::memory_order_relaxed);
+        std::vector<size_t> rows(chunks, 0);
+        std::vector<const char*> badLine(chunks, nullptr), problem(chunks, nullptr);
+        parallelFor(0, chunks, [&](size_t c){
+            EdgeRow row;
+            badLine[c] = forEachLine(t, c, [&](Cursor& cur){
+                if (!parseEdge(cur, n, row)){ problem[c] = cur.problem; return false; }
+                degree[row.from].fetch_add(1, std::memory_order_relaxed);
+                degree[row.to].fetch_add(1, std::memory_order_relaxed);
+                ++rows[c];
+                return true;
+            });
+        }, 1);
+        if (firstError(path, t, badLine, problem, error)) return false;
+
+        std::vector<size_t> firstEdge(chunks + 1, 0);
+        for (size_t c=0; c<chunks; ++c) firstEdge[c+1] = firstEdge[c] + rows[c];
+        const size_t m = firstEdge[chunks];
+        if (2*m >= CsrGraph::kInvalid){ error = path + ": too many edges"; return false; }
+
+        g.offsets.assign(n + 1, 0);
+        for (uint32_t v=0; v<n; ++v) g.offsets[v+1] = g.offsets[v] + degree[v].load(std::memory_order_relaxed);
+        g.targets.resize(2*m);
+        g.weights.resize(2*m);
+        g.arcEdges.resize(2*m);
+        g.edgeEnds.resize(2*m);
+        g.edgeSpeeds.resize(m);
+        g.edgeTolls.resize(m);
+
+        // Pass 2: each edge claims one slot in the slice of either end and
+        // writes its per-edge fields. Arcs only hold the edge id for now, the
+        // one scattered write per arc that cannot be avoided.
+        std::vector<double> edgeWeights(m);
+        std::vector<std::atomic<uint32_t>>& fill = degree;
+        for (uint32_t v=0; v<n; ++v) fill[v].store(g.offsets[v], std::memory_order_relaxed);
+        parallelFor(0, chunks, [&](size_t c){
+            EdgeRow row;
+            CsrGraph::EdgeId e = (CsrGraph::EdgeId)firstEdge[c];
+            forEachLine(t, c, [&](Cursor& cur){
+                parseEdge(cur, n, row);
+                g.arcEdges[fill[row.from].fetch_add(1, std::memory_order_relaxed)] = e;
+                g.arcEdges[fill[row.to].fetch_add(1, std::memory_order_relaxed)] = e;
+                g.edgeEnds[2*e] = row.from; g.edgeEnds[2*e+1] = row.to;
+                edgeWeights[e] = row.weight;
+                g.edgeSpeeds[e] = (float)row.speed;
+                g.edgeTolls[e]  = (float)row.toll;
+                ++e;
+                return true;
+            });
+        }, 1);
+
+        // Pass 3, per node: threads raced for slots, so restore edge order,
+        // then fill in target and weight from the edge.
+        parallelFor(0, n, [&](size_t v){
+            const uint32_t lo = g.offsets[v], hi = g.offsets[v+1];
+            std::sort(g.arcEdges.begin()+lo, g.arcEdges.begin()+hi);
+            for (uint32_t a=lo; a<hi; ++a){
+                const CsrGraph::EdgeId e = g.arcEdges[a];
+                g.targets[a] = g.edgeEnds[2*e] == (NodeId)v ? g.edgeEnds[2*e+1] : g.edgeEnds[2*e];
+                g.weights[a] = edgeWeights[e];
+            }
+        }, 4096);
+        return true;
+    }
+};
@@ -0,0 +1,305 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <limits>
+#include <algorithm>
+#include <numeric>
+#include <iterator>
+
+#include "graph.h"
+#include "dijkstra.h"
+#include "bidirectional.h"
+#include "parallel.h"
+
+// ---------------- Customizable Contraction Hierarchies ----------------
+// Three phases:
+//  1. Ordering (once, metric independent): nested dissection by recursive
+//     coordinate bisection. Separator nodes are ranked above both halves.
+//  2. Contraction (once): eliminating nodes in that order without witness
+//     searches yields a chordal supergraph, stored as upward arcs in rank
+//     space, plus the lower triangles {x, u, w} of every arc u-w.
+//  3. Customization (per metric, seconds): each arc takes the minimum of its
+//     input edges and its lower triangles. Arcs are processed level by level
+//     and every arc only writes itself, so a level runs in parallel.
+// Queries walk the elimination tree from both ends; no priority queue.
+class CustomizableCH {
+public:
+    using NodeId = CsrGraph::NodeId;
+    static constexpr double kInf = std::numeric_limits<double>::infinity();
+    static constexpr uint32_t kNone = CsrGraph::kInvalid;
+
+    // Cells at or below this size are not bisected further.
+    static constexpr uint32_t kLeafCellSize = 16;
+
+    // Weights of the upward arcs under one metric.
+    class Customization {
+    public:
+        bool empty() const { return weights.empty(); }
+    private:
+        friend class CustomizableCH;
+        std::vector<double> weights; // per upward arc
+        std::vector<double> input;   // best original edge per arc, kInf for fill-in
+    };
+
+    CustomizableCH() = default;
+
+    static CustomizableCH build(const CsrGraph& g, const std::vector<Node>& nodes){
+        CustomizableCH cch;
+        const uint32_t n = g.numNodes();
+        cch.order.reserve(n);
+        std::vector<NodeId> all(n);
+        std::iota(all.begin(), all.end(), 0u);
+        std::vector<uint8_t> side(n, 0);
+        cch.dissect(g, nodes, std::move(all), side);
+        cch.rankOf.assign(n, 0);
+        for (uint32_t r=0; r<n; ++r) cch.rankOf[cch.order[r]] = r;
+
+        cch.buildChordalGraph(g);
+        cch.buildTriangles();
+        cch.buildLevels();
+
+        // Original edges behind each arc, so any metric can seed the arcs.
+        std::vector<uint32_t> count(cch.targets.size()+1, 0);
+        std::vector<uint32_t> arcOfEdge(g.numEdges(), kNone);
+        for (CsrGraph::EdgeId e=0; e<g.numEdges(); ++e){
+            uint32_t a = cch.rankOf[g.edgeTail(e)], b = cch.rankOf[g.edgeHead(e)];
+            if (a == b) continue;
+            arcOfEdge[e] = cch.findArc(std::min(a,b), std::max(a,b));
+            ++count[arcOfEdge[e]+1];
+        }
+        for (size_t i=1;i<count.size();++i) count[i] += count[i-1];
+        cch.inputOffsets = count;
+        cch.inputEdges.resize(count.back());
+        for (CsrGraph::EdgeId e=0; e<g.numEdges(); ++e)
+            if (arcOfEdge[e] != kNone) cch.inputEdges[count[arcOfEdge[e]]++] = e;
+        return cch;
+    }
+
+    uint32_t numNodes() const { return (uint32_t)order.size(); }
+    uint32_t numArcs() const { return (uint32_t)targets.size(); }
+    uint32_t numTriangles() const { return (uint32_t)triangles.size()/2; }
+    uint32_t numLevels() const { return (uint32_t)levelOffsets.size()-1; }
+
+    // Phase 3: `edgeWeights` holds one value per original EdgeId.
+    Customization customize(const std::vector<double>& edgeWeights) const {
+        Customization c;
+        c.input.assign(targets.size(), kInf);
+        for (uint32_t a=0; a<targets.size(); ++a)
+            for (uint32_t i=inputOffsets[a]; i<inputOffsets[a+1]; ++i)
+                c.input[a] = std::min(c.input[a], edgeWeights[inputEdges[i]]);
+        c.weights = c.input;
+
+        for (uint32_t level=0; level+1<levelOffsets.size(); ++level){
+            parallelFor(levelOffsets[level], levelOffsets[level+1], [&](size_t i){
+                uint32_t u = levelNodes[i];
+                for (uint32_t a=offsets[u]; a<offsets[u+1]; ++a){
+                    double best = c.weights[a];
+                    for (uint32_t t=triangleOffsets[a]; t<triangleOffsets[a+1]; ++t)
+                        best = std::min(best, c.weights[triangles[2*t]] + c.weights[triangles[2*t+1]]);
+                    c.weights[a] = best;
+                }
+            }, 256);
+        }
+        return c;
+    }
+
+    // Elimination-tree query. Every upward-reachable node of s is an ancestor
+    // of s in the elimination tree, so walking the ancestor chain in rank
+    // order relaxes exactly the upward search space, without a heap.
+    BidirectionalResult query(int source, int target, const Customization& c, BidirectionalContext& ctx) const {
+        QueryContext& F = ctx.forward;
+        QueryContext& B = ctx.backward;
+        F.reset(numNodes()); B.reset(numNodes());
+        BidirectionalResult best;
+        const uint32_t s = rankOf[source], t = rankOf[target];
+
+        auto sweep = [&](uint32_t from, QueryContext& q){
+            q.setLabel((int)from, 0.0, -1);
+            for (uint32_t v=from; v!=kNone; v=parentOf(v)){
+                ++q.stats.settled;
+                const double d = q.dist((int)v);
+                if (d == QueryContext::kInf) continue;
+                for (uint32_t a=offsets[v]; a<offsets[v+1]; ++a){
+                    ++q.stats.relaxed;
+                    double nd = d + c.weights[a];
+                    if (nd < q.dist((int)targets[a])) q.setLabel((int)targets[a], nd, (int)v);
+                }
+            }
+        };
+        sweep(s, F);
+        sweep(t, B);
+        for (uint32_t v=t; v!=kNone; v=parentOf(v)){
+            double through = F.dist((int)v) + B.dist((int)v);
+            if (through < best.distance){ best.distance = through; best.meet = (int)v; }
+        }
+        return best;
+    }
+
+    // Original node ids of the last query's route.
+    std::vector<int> unpackPath(const BidirectionalContext& ctx, int meet, const Customization& c) const {
+        std::vector<int> packed = bidirectionalPath(ctx, meet);
+        std::vector<int> path;
+        if (packed.empty()) return path;
+        path.push_back((int)order[packed.front()]);
+        std::vector<std::pair<uint32_t,uint32_t>> stack;
+        for (size_t i=0; i+1<packed.size(); ++i){
+            stack.push_back({(uint32_t)packed[i], (uint32_t)packed[i+1]});
+            while (!stack.empty()){
+                auto [x, y] = stack.back(); stack.pop_back();
+                uint32_t lo = std::min(x,y), hi = std::max(x,y);
+                uint32_t a = findArc(lo, hi);
+                uint32_t middle = kNone;
+                if (c.weights[a] < c.input[a]){
+                    for (uint32_t t=triangleOffsets[a]; t<triangleOffsets[a+1]; ++t){
+                        if (c.weights[triangles[2*t]] + c.weights[triangles[2*t+1]] == c.weights[a]){
+                            middle = tails[triangles[2*t]]; break;
+                        }
+                    }
+                }
+                if (middle == kNone){ path.push_back((int)order[y]); continue; }
+                stack.push_back({middle, y});
+                stack.push_back({x, middle});
+            }
+        }
+        return path;
+    }
+
+private:
+    // Recursive coordinate bisection; appends `cell` to `order` so that the
+    // separator of every split comes after both halves.
+    // `side` is all zero between calls.
+    void dissect(const CsrGraph& g, const std::vector<Node>& nodes, std::vector<NodeId> cell,
+                 std::vector<uint8_t>& side){
+        if (cell.size() <= kLeafCellSize){
+            order.insert(order.end(), cell.begin(), cell.end());
+            return;
+        }
+        float minX=nodes[cell[0]].x, maxX=minX, minY=nodes[cell[0]].y, maxY=minY;
+        for (NodeId v : cell){
+            minX = std::min(minX, nodes[v].x); maxX = std::max(maxX, nodes[v].x);
+            minY = std::min(minY, nodes[v].y); maxY = std::max(maxY, nodes[v].y);
+        }
+        const bool splitX = (maxX-minX) >= (maxY-minY);
+        // Ties broken by the other axis so the cut stays straight on grids.
+        auto key = [&](NodeId v){
+            return splitX ? std::make_pair(nodes[v].x, nodes[v].y) : std::make_pair(nodes[v].y, nodes[v].x);
+        };
+        auto mid = cell.begin() + cell.size()/2;
+        std::nth_element(cell.begin(), mid, cell.end(), [&](NodeId a, NodeId b){ return key(a) < key(b); });
+
+        // side: 1 = left, 2 = right, 3 = separator, 0 = outside this cell
+        for (auto it=cell.begin(); it!=cell.end(); ++it) side[*it] = it < mid ? 1 : 2;
+        // Separator = right-hand endpoints of cut edges (a vertex cover of the cut).
+        for (auto it=mid; it!=cell.end(); ++it){
+            for (auto a=g.arcBegin(*it); a<g.arcEnd(*it); ++a)
+                if (side[g.arcTarget(a)] == 1){ side[*it] = 3; break; }
+        }
+        std::vector<NodeId> left, right, separator;
+        for (NodeId v : cell){
+            (side[v]==1 ? left : side[v]==2 ? right : separator).push_back(v);
+        }
+        for (NodeId v : cell) side[v] = 0;
+        cell.clear(); cell.shrink_to_fit();
+
+        if (left.empty() || right.empty()){ // degenerate split (duplicate coordinates)
+            order.insert(order.end(), left.begin(), left.end());
+            order.insert(order.end(), right.begin(), right.end());
+        } else {
+            dissect(g, nodes, std::move(left), side);
+            dissect(g, nodes, std::move(right), side);
+        }
+        order.insert(order.end(), separator.begin(), separator.end());
+    }
+
+    // Eliminates nodes in rank order: the upper neighbours of v become a
+    // clique, which is added by merging them into the lowest of them.
+    void buildChordalGraph(const CsrGraph& g){
+        const uint32_t n = numNodes();
+        std::vector<std::vector<uint32_t>> up(n);
+        for (NodeId u=0; u<n; ++u){
+            for (auto a=g.arcBegin(u); a<g.arcEnd(u); ++a){
+                uint32_t ru = rankOf[u], rv = rankOf[g.arcTarget(a)];
+                if (ru < rv) up[ru].push_back(rv);
+            }
+        }
+        parents.assign(n, kNone);
+        std::vector<uint32_t> merged;
+        for (uint32_t v=0; v<n; ++v){
+            auto& nb = up[v];
+            std::sort(nb.begin(), nb.end());
+            nb.erase(std::unique(nb.begin(), nb.end()), nb.end());
+            if (nb.empty()) continue;
+            uint32_t p = nb.front();
+            parents[v] = p;
+            merged.clear();
+            std::set_union(up[p].begin(), up[p].end(), nb.begin()+1, nb.end(), std::back_inserter(merged));
+            up[p].swap(merged);
+        }
+        offsets.assign(n+1, 0);
+        for (uint32_t v=0; v<n; ++v) offsets[v+1] = offsets[v] + (uint32_t)up[v].size();
+        targets.reserve(offsets[n]);
+        tails.reserve(offsets[n]);
+        for (uint32_t v=0; v<n; ++v){
+            targets.insert(targets.end(), up[v].begin(), up[v].end());
+            tails.insert(tails.end(), up[v].size(), v);
+        }
+    }
+
+    // For every arc u-w, the pairs (x-u, x-w) with x below u.
+    void buildTriangles(){
+        std::vector<uint32_t> count(targets.size()+1, 0);
+        auto forEachTriangle = [&](auto&& f){
+            for (uint32_t x=0; x<numNodes(); ++x)
+                for (uint32_t i=offsets[x]; i<offsets[x+1]; ++i)
+                    for (uint32_t j=i+1; j<offsets[x+1]; ++j)
+                        f(findArc(targets[i], targets[j]), i, j);
+        };
+        forEachTriangle([&](uint32_t a, uint32_t, uint32_t){ ++count[a+1]; });
+        for (size_t i=1;i<count.size();++i) count[i] += count[i-1];
+        triangleOffsets = count;
+        triangles.resize(2*(size_t)count.back());
+        forEachTriangle([&](uint32_t a, uint32_t i, uint32_t j){
+            uint32_t t = count[a]++;
+            triangles[2*t] = i; triangles[2*t+1] = j;
+        });
+    }
+
+    // level(v) = 1 + highest level below it; nodes of one level share no arc
+    // that another node of the same level reads.
+    void buildLevels(){
+        const uint32_t n = numNodes();
+        std::vector<uint32_t> level(n, 0);
+        uint32_t maxLevel = 0;
+        for (uint32_t v=0; v<n; ++v){
+            maxLevel = std::max(maxLevel, level[v]);
+            for (uint32_t a=offsets[v]; a<offsets[v+1]; ++a)
+                level[targets[a]] = std::max(level[targets[a]], level[v]+1);
+        }
+        levelOffsets.assign(maxLevel+2, 0);
+        for (uint32_t v=0; v<n; ++v) ++levelOffsets[level[v]+1];
+        for (size_t i=1;i<levelOffsets.size();++i) levelOffsets[i] += levelOffsets[i-1];
+        levelNodes.resize(n);
+        std::vector<uint32_t> fill(levelOffsets.begin(), levelOffsets.end()-1);
+        for (uint32_t v=0; v<n; ++v) levelNodes[fill[level[v]]++] = v;
+    }
+
+    // Arc lo->hi (both ranks, lo < hi); targets of a node are sorted.
+    uint32_t findArc(uint32_t lo, uint32_t hi) const {
+        auto first = targets.begin() + offsets[lo], last = targets.begin() + offsets[lo+1];
+        auto it = std::lower_bound(first, last, hi);
+        return (it != last && *it == hi) ? (uint32_t)(it - targets.begin()) : kNone;
+    }
+
+    uint32_t parentOf(uint32_t v) const { return parents[v]; }
+
+    std::vector<NodeId>   order;   // rank -> node
+    std::vector<uint32_t> rankOf;  // node -> rank
+    std::vector<uint32_t> parents; // elimination tree, in rank space
+
+    // Upward arcs in rank space
+    std::vector<uint32_t> offsets, targets, tails;
+    std::vector<uint32_t> triangleOffsets, triangles; // arc ids, two per triangle
+    std::vector<uint32_t> inputOffsets, inputEdges;   // original edges per arc
+    std::vector<uint32_t> levelOffsets, levelNodes;
+};
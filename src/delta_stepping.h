@@ -0,0 +1,161 @@
+#pragma once
+
+#include <vector>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+#include "graph.h"
+#include "parallel.h"
+
+// ---------------- Delta-stepping SSSP ----------------
+// One-to-all distances using every core. Tentative distances are grouped in
+// buckets of width `delta`; the lowest non-empty bucket is settled in rounds
+// that relax all its nodes' light arcs (w <= delta) at once, since those can
+// refill the same bucket, and then their heavy arcs once, since those never
+// can. Within a round relaxations run in parallel and meet only in an atomic
+// minimum on the distance array.
+//
+// delta trades work for parallelism: tiny values degenerate into Dijkstra
+// (many small rounds), huge ones into Bellman-Ford (re-relaxations).
+// suggestDelta() gives a starting point. Buckets form a ring of at most
+// kMaxBuckets, so a tiny delta costs rounds, never memory.
+class DeltaStepping {
+public:
+    static constexpr double kInf = std::numeric_limits<double>::infinity();
+
+    // Mean arc weight: about one hop per bucket on road-like graphs.
+    static double suggestDelta(const CsrGraph& g){
+        if (g.numArcs() == 0) return 1.0;
+        double sum = 0.0;
+        for (CsrGraph::ArcId a=0; a<g.numArcs(); ++a) sum += g.arcWeight(a);
+        return std::max(sum / g.numArcs(), 1e-9);
+    }
+
+    // Distances from `source`, kInf where unreachable.
+    static std::vector<double> run(const CsrGraph& g, CsrGraph::NodeId source, double delta){
+        DeltaStepping ds(g, delta);
+        ds.solve(source);
+        std::vector<double> out(g.numNodes());
+        for (CsrGraph::NodeId v=0; v<g.numNodes(); ++v) out[v] = ds.load(v);
+        return out;
+    }
+
+private:
+    using NodeId = CsrGraph::NodeId;
+
+    DeltaStepping(const CsrGraph& g_, double delta_)
+        : g(g_), delta(delta_ > 0.0 ? delta_ : suggestDelta(g_)), dist(g_.numNodes()), processed(g_.numNodes(), 0) {
+        for (auto& d : dist) d.store(bits(kInf), std::memory_order_relaxed);
+        // Pending labels never lie more than one arc beyond the current
+        // bucket, so a ring of maxWeight/delta buckets covers them all. A
+        // smaller ring shares slots between buckets a lap apart; solve()
+        // keeps the later ones for their own lap.
+        double maxWeight = 0.0;
+        for (CsrGraph::ArcId a=0; a<g.numArcs(); ++a) maxWeight = std::max(maxWeight, g.arcWeight(a));
+        buckets.resize((size_t)std::min(maxWeight / delta + 2.0, (double)kMaxBuckets));
+    }
+
+    // Non-negative doubles order like their bit patterns, so the atomic
+    // minimum is a compare-and-swap loop on the raw 64 bits.
+    static uint64_t bits(double d){ uint64_t b; std::memcpy(&b, &d, sizeof b); return b; }
+    static double value(uint64_t b){ double d; std::memcpy(&d, &b, sizeof d); return d; }
+    double load(NodeId v) const { return value(dist[v].load(std::memory_order_relaxed)); }
+
+    bool relaxMin(NodeId v, double d){
+        const uint64_t nb = bits(d);
+        uint64_t cur = dist[v].load(std::memory_order_relaxed);
+        while (nb < cur){
+            if (dist[v].compare_exchange_weak(cur, nb, std::memory_order_relaxed)) return true;
+        }
+        return false;
+    }
+
+    size_t bucketOf(double d) const { return (size_t)(d / delta); }
+
+    void insert(NodeId v){
+        buckets[bucketOf(load(v)) % buckets.size()].push_back(v);
+        ++pending;
+    }
+
+    // Relaxes the light or heavy arcs of `nodes` in parallel, then files every
+    // improved target into its bucket.
+    void relaxAll(const std::vector<NodeId>& nodes, bool light){
+        if (nodes.empty()) return;
+        const size_t chunks = std::min<size_t>(workers * 4, (nodes.size() + kChunk - 1) / kChunk);
+        std::vector<std::vector<NodeId>> improved(chunks);
+        const size_t per = (nodes.size() + chunks - 1) / chunks;
+        parallelFor(0, chunks, [&](size_t c){
+            auto& out = improved[c];
+            for (size_t i=c*per; i<std::min(nodes.size(), (c+1)*per); ++i){
+                const NodeId u = nodes[i];
+                const double du = load(u);
+                for (auto a=g.arcBegin(u); a<g.arcEnd(u); ++a){
+                    const double w = g.arcWeight(a);
+                    if ((w <= delta) != light) continue;
+                    if (relaxMin(g.arcTarget(a), du + w)) out.push_back(g.arcTarget(a));
+                }
+            }
+        }, 1);
+        for (const auto& out : improved) for (NodeId v : out) insert(v);
+    }
+
+    // Lowest bucket any pending entry is filed for; after a whole lap of the
+    // ring settled nothing, the search jumps there instead of stepping
+    // through empty buckets one by one.
+    size_t nextBucket() const {
+        size_t next = ~size_t(0);
+        for (const auto& bucket : buckets) for (NodeId v : bucket) next = std::min(next, bucketOf(load(v)));
+        return next;
+    }
+
+    void solve(NodeId source){
+        if (source >= g.numNodes()) return;
+        relaxMin(source, 0.0);
+        insert(source);
+        uint32_t round = 0;
+        std::vector<NodeId> frontier, settled, later;
+        for (size_t i=0, idle=0; pending > 0; ++i){
+            if (idle == buckets.size()){ i = nextBucket(); idle = 0; }
+            auto& bucket = buckets[i % buckets.size()];
+            settled.clear();
+            later.clear();
+            while (!bucket.empty()){
+                // Keep live entries only: still in bucket i, once per round.
+                // Entries for a later lap wait in `later`.
+                ++round;
+                frontier.clear();
+                for (NodeId v : bucket){
+                    const size_t b = bucketOf(load(v));
+                    if (b > i) later.push_back(v);
+                    else if (b == i && processed[v] != round){ processed[v] = round; frontier.push_back(v); }
+                }
+                pending -= bucket.size();
+                bucket.clear();
+                settled.insert(settled.end(), frontier.begin(), frontier.end());
+                relaxAll(frontier, true);
+            }
+            bucket.swap(later);
+            pending += bucket.size();
+            if (settled.empty()){ ++idle; continue; }
+            idle = 0;
+            std::sort(settled.begin(), settled.end());
+            settled.erase(std::unique(settled.begin(), settled.end()), settled.end());
+            relaxAll(settled, false);
+        }
+    }
+
+    static constexpr size_t kChunk = 256;            // frontier nodes per task
+    static constexpr size_t kMaxBuckets = 1u << 16;  // ring size cap
+
+    const CsrGraph& g;
+    const double delta;
+    const size_t workers = sharedPool().size();
+    std::vector<std::atomic<uint64_t>> dist;
+    std::vector<uint32_t> processed; // round a node was last expanded in
+    std::vector<std::vector<NodeId>> buckets; // ring: bucket i lives at i % size
+    size_t pending = 0;                       // entries across all buckets
+};
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <vector>
+#include <utility>
+#include <cstdint>
+#include <limits>
+#include <algorithm>
+#include <functional>
+
+// Per-query counters, reset together with the labels.
+struct QueryStats {
+    uint32_t settled = 0;  // nodes popped with a final label
+    uint32_t relaxed = 0;  // arcs scanned
+};
+
+// ---------------- Reusable query state ----------------
+// Dense dist/parent arrays that survive between queries. Instead of clearing
+// them (O(V)) every query bumps `generation`; an entry is only valid when its
+// stamp matches. The heap keeps its capacity too, so after the first query on
+// a graph nothing is allocated on the search path.
+class QueryContext {
+public:
+    static constexpr double kInf = std::numeric_limits<double>::infinity();
+
+    // Make room for `numNodes` and invalidate every label from the last query.
+    void reset(size_t numNodes){
+        if (stamps.size() < numNodes){
+            distance.resize(numNodes);
+            parents.resize(numNodes);
+            stamps.resize(numNodes, 0);
+        }
+        if (++generation == 0){ // wrapped: old stamps could alias, wipe once
+            std::fill(stamps.begin(), stamps.end(), 0u);
+            generation = 1;
+        }
+        heap.clear();
+        stats = QueryStats{};
+    }
+
+    bool reached(int v) const { return stamps[v] == generation; }
+    double dist(int v) const { return reached(v) ? distance[v] : kInf; }
+    int parent(int v) const { return reached(v) ? parents[v] : -1; }
+
+    void setLabel(int v, double d, int p){
+        distance[v] = d; parents[v] = p; stamps[v] = generation;
+    }
+
+    // Lazy-deletion binary heap of (key, node). Stale entries are skipped by
+    // the caller when the popped key no longer matches the node's label.
+    void push(double key, int v){
+        heap.push_back({key, v});
+        std::push_heap(heap.begin(), heap.end(), std::greater<>());
+    }
+    std::pair<double,int> pop(){
+        std::pop_heap(heap.begin(), heap.end(), std::greater<>());
+        auto top = heap.back(); heap.pop_back();
+        return top;
+    }
+    bool empty() const { return heap.empty(); }
+    double topKey() const { return heap.front().first; } // may belong to a stale entry
+
+    // Walks parents back from `target`; empty if it was never reached.
+    std::vector<int> pathTo(int target) const {
+        std::vector<int> path;
+        if (!reached(target)) return path;
+        for (int cur=target; cur!=-1; cur=parents[cur]) path.push_back(cur);
+        std::reverse(path.begin(), path.end());
+        return path;
+    }
+
+    QueryStats stats;
+
+private:
+    std::vector<double>   distance;
+    std::vector<int>      parents;
+    std::vector<uint32_t> stamps;
+    uint32_t generation = 0;
+    std::vector<std::pair<double,int>> heap;
+};
+
+// One context per thread so concurrent callers never share labels.
+inline QueryContext& threadQueryContext(){
+    thread_local QueryContext ctx;
+    return ctx;
+}
+
+// ---------------- Dijkstra / A* ----------------
+// Potential that gives no guidance; turns astar() into plain Dijkstra.
+struct ZeroPotential {
+    double operator()(int) const { return 0.0; }
+};
+
+// Point-to-point A*: the heap is keyed by dist(v) + pot(v). `pot` must be
+// consistent (pot(u) <= w(u,v) + pot(v)) so every node is settled once.
+// Stops as soon as `target` is settled (pass -1 to settle everything
+// reachable). Returns dist(target), or kInf if unreachable. Labels stay in
+// `ctx` until its next reset, so callers can read the tree.
+// Graph needs numNodes() and forEachArc(u, f(v, w)) (see CsrGraph).
+template<class Graph, class Potential>
+double astar(const Graph& g, int source, int target, QueryContext& ctx, const Potential& pot){
+    ctx.reset(g.numNodes());
+    ctx.setLabel(source, 0.0, -1);
+    ctx.push(pot(source), source);
+
+    while (!ctx.empty()){
+        auto [key, u] = ctx.pop();
+        const double d = ctx.dist(u);
+        if (key > d + pot(u)) continue; // stale entry
+        ++ctx.stats.settled;
+        if (u == target) return d;
+        g.forEachArc(u, [&](uint32_t v, double w){
+            ++ctx.stats.relaxed;
+            double nd = d + w;
+            if (nd < ctx.dist((int)v)){
+                ctx.setLabel((int)v, nd, u);
+                ctx.push(nd + pot((int)v), (int)v);
+            }
+        });
+    }
+    return target >= 0 ? ctx.dist(target) : QueryContext::kInf;
+}
+
+template<class Graph>
+double dijkstra(const Graph& g, int source, int target, QueryContext& ctx){
+    return astar(g, source, target, ctx, ZeroPotential{});
+}
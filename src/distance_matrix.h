@@ -0,0 +1,159 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <limits>
+#include <fstream>
+#include <algorithm>
+
+#include "graph.h"
+#include "parallel.h"
+
+// ---------------- All-pairs distance / next-hop matrix ----------------
+// For graphs up to a few thousand nodes it is cheaper to answer every query
+// by lookup: dist[u][v] plus the first hop next[u][v], from which the path is
+// read off in O(path length).
+//
+// Built with blocked Floyd-Warshall: for each pivot tile K, first the K-K
+// tile, then the tiles in row/column K, then every other tile, each phase
+// reading only tiles finished by the previous one, so tiles within a phase
+// run in parallel. The inner loop is a branch-free min/select over a
+// contiguous row, which compilers turn into vector blends.
+//
+// Paths are compared by (distance, hops). On distance alone, zero-weight
+// roads leave ties, and next[u][t] and next[v][t] can point at each other
+// across a plateau. With hops as tie-break every next hop is one hop closer
+// to t, so walking next[] always ends.
+class DistanceMatrix {
+public:
+    static constexpr uint32_t kTile = 64;
+    static constexpr double   kInf  = std::numeric_limits<double>::infinity();
+    static constexpr uint32_t kNone = CsrGraph::kInvalid;
+
+    DistanceMatrix() = default;
+
+    static DistanceMatrix build(const CsrGraph& g){
+        DistanceMatrix m;
+        m.n = g.numNodes();
+        m.stride = (m.n + kTile - 1) / kTile * kTile;
+        const size_t cells = (size_t)m.stride * m.stride;
+        m.dist.assign(cells, kInf);
+        m.next.assign(cells, kNone);
+        std::vector<uint32_t> hops(cells, 0); // edges on the path; only read where dist is finite
+        for (uint32_t u=0; u<m.n; ++u){
+            m.dist[m.at(u,u)] = 0.0; m.next[m.at(u,u)] = u;
+            for (auto a=g.arcBegin(u); a<g.arcEnd(u); ++a){
+                uint32_t v = g.arcTarget(a);
+                if (v != u && g.arcWeight(a) < m.dist[m.at(u,v)]){
+                    m.dist[m.at(u,v)] = g.arcWeight(a); m.next[m.at(u,v)] = v; hops[m.at(u,v)] = 1;
+                }
+            }
+        }
+
+        const uint32_t tiles = m.stride / kTile;
+        for (uint32_t K=0; K<tiles; ++K){
+            m.relaxTile(K, K, K, hops);
+            parallelFor(0, tiles, [&](size_t T){
+                if (T == K) return;
+                m.relaxTile(K, (uint32_t)T, K, hops);
+                m.relaxTile((uint32_t)T, K, K, hops);
+            }, 1);
+            parallelFor(0, (size_t)tiles*tiles, [&](size_t IJ){
+                uint32_t I = (uint32_t)(IJ / tiles), J = (uint32_t)(IJ % tiles);
+                if (I != K && J != K) m.relaxTile(I, J, K, hops);
+            }, 1);
+        }
+        return m;
+    }
+
+    bool empty() const { return n == 0; }
+    uint32_t numNodes() const { return n; }
+    size_t sizeBytes() const { return dist.size()*sizeof(double) + next.size()*sizeof(uint32_t); }
+
+    double distance(uint32_t u, uint32_t v) const { return dist[at(u,v)]; }
+
+    // Node sequence u..v by next hops; empty if v is unreachable, or if the
+    // walk does not reach v within n steps (a damaged table), so callers
+    // can fall back to a search.
+    std::vector<int> path(uint32_t u, uint32_t v) const {
+        std::vector<int> out;
+        if (next[at(u,v)] == kNone) return out;
+        out.push_back((int)u);
+        while (u != v){
+            if (out.size() > n) return {};
+            u = next[at(u,v)];
+            if (u >= n) return {};
+            out.push_back((int)u);
+        }
+        return out;
+    }
+
+    // ---- persistence ----
+    // Raw dump of both padded arrays behind a small header; reloading is two
+    // reads with no parsing.
+    bool save(const std::string& path, uint64_t graphFingerprint) const {
+        std::ofstream out(path, std::ios::binary);
+        if (!out) return false;
+        const uint32_t header[4] = { kMagic, kVersion, n, stride };
+        out.write((const char*)header, sizeof(header));
+        out.write((const char*)&graphFingerprint, sizeof(graphFingerprint));
+        out.write((const char*)dist.data(), dist.size()*sizeof(double));
+        out.write((const char*)next.data(), next.size()*sizeof(uint32_t));
+        return (bool)out;
+    }
+
+    static bool load(const std::string& path, uint64_t graphFingerprint, uint32_t expectedNodes, DistanceMatrix& m){
+        std::ifstream in(path, std::ios::binary);
+        if (!in) return false;
+        uint32_t header[4] = {};
+        uint64_t fingerprint = 0;
+        in.read((char*)header, sizeof(header));
+        in.read((char*)&fingerprint, sizeof(fingerprint));
+        if (!in || header[0] != kMagic || header[1] != kVersion || header[2] != expectedNodes ||
+            header[3] % kTile != 0 || fingerprint != graphFingerprint) return false;
+        m.n = header[2]; m.stride = header[3];
+        m.dist.resize((size_t)m.stride*m.stride);
+        m.next.resize((size_t)m.stride*m.stride);
+        in.read((char*)m.dist.data(), m.dist.size()*sizeof(double));
+        in.read((char*)m.next.data(), m.next.size()*sizeof(uint32_t));
+        if (!in){ m = DistanceMatrix(); return false; }
+        return true;
+    }
+
+private:
+    static constexpr uint32_t kMagic   = 0x4D444650; // "PFDM"
+    static constexpr uint32_t kVersion = 2; // 1 could hold next-hop cycles
+
+    size_t at(uint32_t u, uint32_t v) const { return (size_t)u*stride + v; }
+
+    // Floyd-Warshall step on tile (I,J) for every pivot k in tile K; a
+    // candidate wins on shorter distance, or equal distance in fewer hops.
+    void relaxTile(uint32_t I, uint32_t J, uint32_t K, std::vector<uint32_t>& hops){
+        const uint32_t i0 = I*kTile, j0 = J*kTile, k0 = K*kTile;
+        for (uint32_t k=k0; k<k0+kTile; ++k){
+            const double*   dk = &dist[at(k, j0)];
+            const uint32_t* hk = &hops[at(k, j0)];
+            for (uint32_t i=i0; i<i0+kTile; ++i){
+                const double dik = dist[at(i,k)];
+                if (dik == kInf) continue;
+                const uint32_t nik = next[at(i,k)], hik = hops[at(i,k)];
+                double*   di = &dist[at(i, j0)];
+                uint32_t* ni = &next[at(i, j0)];
+                uint32_t* hi = &hops[at(i, j0)];
+                for (uint32_t j=0; j<kTile; ++j){
+                    const double cand = dik + dk[j];
+                    const uint32_t candHops = hik + hk[j];
+                    const bool better = cand < di[j] || (cand == di[j] && cand != kInf && candHops < hi[j]);
+                    di[j] = better ? cand : di[j];
+                    ni[j] = better ? nik  : ni[j];
+                    hi[j] = better ? candHops : hi[j];
+                }
+            }
+        }
+    }
+
+    uint32_t n = 0, stride = 0;
+    std::vector<double>   dist; // stride x stride, padding stays at kInf
+    std::vector<uint32_t> next; // first hop on a shortest u->v path
+};
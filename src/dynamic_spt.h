@@ -0,0 +1,146 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <limits>
+#include <algorithm>
+#include <functional>
+
+#include "graph.h"
+
+// ---------------- Dynamic shortest-path tree ----------------
+// A full single-source tree (distance, parent, parent edge per node) that is
+// repaired after weight changes instead of recomputed, in the manner of
+// Ramalingam & Reps: only nodes whose distance actually changes are touched.
+//  - An edge that got heavier and carries a tree arc invalidates the subtree
+//    below it. Those nodes drop their labels and restart from the best
+//    offer of an unaffected neighbour.
+//  - An edge that got lighter offers a shorter label to one of its ends.
+// One Dijkstra pass over the seeded nodes then settles both cases together.
+class ShortestPathTree {
+public:
+    using NodeId = CsrGraph::NodeId;
+    using EdgeId = CsrGraph::EdgeId;
+    static constexpr double kInf = std::numeric_limits<double>::infinity();
+
+    ShortestPathTree() = default;
+
+    static ShortestPathTree build(const CsrGraph& g, NodeId source){
+        ShortestPathTree t;
+        const uint32_t n = g.numNodes();
+        t.root = source;
+        t.distance.assign(n, kInf);
+        t.parents.assign(n, -1);
+        t.parentEdges.assign(n, CsrGraph::kInvalid);
+        t.distance[source] = 0.0;
+        t.heap.push_back({0.0, source});
+        t.propagate(g);
+        t.version = g.version();
+        return t;
+    }
+
+    bool empty() const { return distance.empty(); }
+    NodeId source() const { return root; }
+    uint64_t graphVersion() const { return version; } // graph.version() the tree matches
+    double dist(NodeId v) const { return distance[v]; }
+    int parent(NodeId v) const { return parents[v]; }
+    EdgeId parentEdge(NodeId v) const { return parentEdges[v]; }
+
+    std::vector<int> pathTo(NodeId target) const {
+        std::vector<int> path;
+        if (distance[target] == kInf) return path;
+        for (int cur=(int)target; cur!=-1; cur=parents[cur]) path.push_back(cur);
+        std::reverse(path.begin(), path.end());
+        return path;
+    }
+
+    // `g` already carries the new weights; `changed` lists the edges whose
+    // weight differs from what the tree was built on. Returns how many nodes
+    // were settled again.
+    uint32_t repair(const CsrGraph& g, const std::vector<EdgeId>& changed){
+        heap.clear();
+
+        // Heavier tree edges: collect the subtrees hanging below them.
+        std::vector<NodeId> affected;
+        for (EdgeId e : changed){
+            NodeId a = g.edgeTail(e), b = g.edgeHead(e);
+            NodeId child = parentEdges[b] == e && parents[b] == (int)a ? b
+                         : parentEdges[a] == e && parents[a] == (int)b ? a : CsrGraph::kInvalid;
+            if (child == CsrGraph::kInvalid || distance[child] == kInf) continue;
+            const NodeId up = (NodeId)parents[child];
+            if (distance[up] + g.edgeWeight(e) <= distance[child]) continue; // got lighter or unchanged
+            collectSubtree(g, child, affected);
+        }
+        for (NodeId v : affected){ distance[v] = kInf; parents[v] = -1; parentEdges[v] = CsrGraph::kInvalid; }
+        for (NodeId v : affected){
+            for (auto a=g.arcBegin(v); a<g.arcEnd(v); ++a){
+                NodeId u = g.arcTarget(a);
+                if (inSubtree[u]) continue;
+                offer(v, u, g.arcEdge(a), distance[u] + g.arcWeight(a));
+            }
+        }
+        for (NodeId v : affected) inSubtree[v] = 0;
+
+        // Lighter edges: each end may now be reached more cheaply via the other.
+        for (EdgeId e : changed){
+            NodeId a = g.edgeTail(e), b = g.edgeHead(e);
+            const double w = g.edgeWeight(e);
+            offer(b, a, e, distance[a] + w);
+            offer(a, b, e, distance[b] + w);
+        }
+
+        const uint32_t settled = propagate(g);
+        version = g.version();
+        return settled;
+    }
+
+private:
+    // Records u->v as v's tree arc if it improves v's label.
+    void offer(NodeId v, NodeId u, EdgeId e, double d){
+        if (d < distance[v]){
+            distance[v] = d; parents[v] = (int)u; parentEdges[v] = e;
+            heap.push_back({d, v});
+            std::push_heap(heap.begin(), heap.end(), std::greater<>());
+        }
+    }
+
+    // Dijkstra from whatever is in the heap; returns the number of settles.
+    uint32_t propagate(const CsrGraph& g){
+        uint32_t settled = 0;
+        while (!heap.empty()){
+            std::pop_heap(heap.begin(), heap.end(), std::greater<>());
+            auto [d, u] = heap.back(); heap.pop_back();
+            if (d > distance[u]) continue; // stale entry
+            ++settled;
+            for (auto a=g.arcBegin(u); a<g.arcEnd(u); ++a)
+                offer(g.arcTarget(a), u, g.arcEdge(a), d + g.arcWeight(a));
+        }
+        return settled;
+    }
+
+    // Appends every tree descendant of `top` (inclusive) not yet collected.
+    void collectSubtree(const CsrGraph& g, NodeId top, std::vector<NodeId>& out){
+        if (inSubtree.size() < distance.size()) inSubtree.assign(distance.size(), 0);
+        if (inSubtree[top]) return;
+        std::vector<NodeId> stack{top};
+        inSubtree[top] = 1;
+        while (!stack.empty()){
+            NodeId v = stack.back(); stack.pop_back();
+            out.push_back(v);
+            for (auto a=g.arcBegin(v); a<g.arcEnd(v); ++a){
+                NodeId c = g.arcTarget(a);
+                if (!inSubtree[c] && parents[c] == (int)v && parentEdges[c] == g.arcEdge(a)){
+                    inSubtree[c] = 1; stack.push_back(c);
+                }
+            }
+        }
+    }
+
+    NodeId root = 0;
+    uint64_t version = 0;
+    std::vector<double> distance;
+    std::vector<int>    parents;
+    std::vector<EdgeId> parentEdges;
+    std::vector<uint8_t> inSubtree; // scratch for repair(), all zero between calls
+    std::vector<std::pair<double, NodeId>> heap;
+};
@@ -0,0 +1,215 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <utility>
+#include <atomic>
+#include <memory>
+
+// ---------------- Data types (classes) ----------------
+class Node {
+public:
+    float x{}, y{};
+    std::string name;
+
+    Node() = default;
+    Node(float x_, float y_, std::string name_) : x(x_), y(y_), name(std::move(name_)) {}
+};
+
+class WeightedLine {
+public:
+    int start{}, end{};
+    double weight{};
+    double speed{};  // distance-units per hour; 0 = network default
+    double toll{};   // flat charge for using the road, in currency units
+
+    WeightedLine() = default;
+    WeightedLine(int s, int e, double w) : start(s), end(e), weight(w) {}
+    WeightedLine(int s, int e, double w, double speed_, double toll_)
+        : start(s), end(e), weight(w), speed(speed_), toll(toll_) {}
+};
+
+// ---------------- Array storage ----------------
+// Read-only array that either owns a vector or views memory kept alive by
+// `backing` (a mapped graph file, see graph_file.h). Reads cost the same
+// either way; writable() turns a view into an owned copy first, so changing
+// a mapped array never writes to the file.
+template<class T>
+class Column {
+public:
+    Column() = default;
+    Column(std::vector<T>&& v) : owned(std::move(v)) { point(); }
+    Column(const T* p, size_t n, std::shared_ptr<const void> keepAlive)
+        : first(p), count(n), backing(std::move(keepAlive)) {}
+    Column(const Column& o) : owned(o.owned), first(o.first), count(o.count), backing(o.backing) { if (!backing) point(); }
+    Column(Column&& o) noexcept
+        : owned(std::move(o.owned)), first(o.first), count(o.count), backing(std::move(o.backing)) { o.first = nullptr; o.count = 0; }
+    Column& operator=(Column o) noexcept {
+        std::swap(owned, o.owned); std::swap(first, o.first); std::swap(count, o.count); std::swap(backing, o.backing);
+        return *this;
+    }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    const T* data() const { return first; }
+    const T* begin() const { return first; }
+    const T* end() const { return first + count; }
+    const T& operator[](size_t i) const { return first[i]; }
+    bool isMapped() const { return backing != nullptr; }
+
+    T* writable(){
+        if (backing){ owned.assign(first, first + count); backing.reset(); point(); }
+        return owned.data();
+    }
+
+private:
+    void point(){ first = owned.data(); count = owned.size(); }
+
+    std::vector<T> owned;
+    const T* first = nullptr;
+    size_t count = 0;
+    std::shared_ptr<const void> backing;
+};
+
+// ---------------- CSR graph ----------------
+// Compressed-sparse-row graph with fixed topology; only weights may change.
+// Every undirected WeightedLine is stored once as an edge (for drawing) and
+// twice as arcs (u->v, v->u) so the neighbours of a node sit in one
+// contiguous slice of targets/weights. The arrays may be views into a mapped
+// graph file; the first weight update copies the weights out of it.
+class CsrGraph {
+public:
+    using NodeId = uint32_t;
+    using ArcId  = uint32_t;
+    using EdgeId = uint32_t;
+    static constexpr uint32_t kInvalid = ~0u;
+
+    CsrGraph() = default;
+
+    static CsrGraph build(size_t numNodes, const std::vector<WeightedLine>& edges){
+        Parts g;
+        g.offsets.assign(numNodes+1, 0);
+        for (const auto& e : edges){ ++g.offsets[e.start+1]; ++g.offsets[e.end+1]; }
+        for (size_t i=0;i<numNodes;++i) g.offsets[i+1] += g.offsets[i];
+
+        const size_t numArcs = g.offsets[numNodes];
+        g.targets.resize(numArcs);
+        g.weights.resize(numArcs);
+        g.arcEdges.resize(numArcs);
+        g.edgeEnds.resize(edges.size()*2);
+        g.edgeSpeeds.resize(edges.size());
+        g.edgeTolls.resize(edges.size());
+
+        std::vector<uint32_t> fill(g.offsets.begin(), g.offsets.end()-1);
+        for (size_t i=0;i<edges.size();++i){
+            const auto& e = edges[i];
+            uint32_t a = fill[e.start]++;
+            g.targets[a] = (NodeId)e.end;   g.weights[a] = e.weight; g.arcEdges[a] = (EdgeId)i;
+            uint32_t b = fill[e.end]++;
+            g.targets[b] = (NodeId)e.start; g.weights[b] = e.weight; g.arcEdges[b] = (EdgeId)i;
+            g.edgeEnds[2*i]   = (NodeId)e.start;
+            g.edgeEnds[2*i+1] = (NodeId)e.end;
+            g.edgeSpeeds[i] = (float)e.speed;
+            g.edgeTolls[i]  = (float)e.toll;
+        }
+        return fromParts(std::move(g));
+    }
+
+    // Raw CSR arrays for loaders that fill them in place (see csv_loader.h).
+    // Arcs of a node must be ordered by edge id, as build() leaves them, so
+    // the same network always gets the same fingerprint.
+    struct Parts {
+        std::vector<uint32_t> offsets;
+        std::vector<NodeId>   targets;
+        std::vector<double>   weights;
+        std::vector<EdgeId>   arcEdges;
+        std::vector<NodeId>   edgeEnds;
+        std::vector<float>    edgeSpeeds;
+        std::vector<float>    edgeTolls;
+    };
+    static CsrGraph fromParts(Parts&& p){
+        CsrGraph g;
+        g.revision = nextRevision();
+        g.offsets = std::move(p.offsets);
+        g.targets = std::move(p.targets);
+        g.weights = std::move(p.weights);
+        g.arcEdges = std::move(p.arcEdges);
+        g.edgeEnds = std::move(p.edgeEnds);
+        g.edgeSpeeds = std::move(p.edgeSpeeds);
+        g.edgeTolls = std::move(p.edgeTolls);
+        return g;
+    }
+
+    uint32_t numNodes() const { return offsets.empty() ? 0 : (uint32_t)offsets.size()-1; }
+    uint32_t numArcs()  const { return (uint32_t)targets.size(); }
+    uint32_t numEdges() const { return (uint32_t)edgeEnds.size()/2; }
+
+    ArcId  arcBegin(NodeId u) const { return offsets[u]; }
+    ArcId  arcEnd(NodeId u)   const { return offsets[u+1]; }
+    NodeId arcTarget(ArcId a) const { return targets[a]; }
+    double arcWeight(ArcId a) const { return weights[a]; }
+    EdgeId arcEdge(ArcId a)   const { return arcEdges[a]; }
+
+    NodeId edgeTail(EdgeId e) const { return edgeEnds[2*e]; }
+    NodeId edgeHead(EdgeId e) const { return edgeEnds[2*e+1]; }
+    double edgeWeight(EdgeId e) const {
+        NodeId u = edgeTail(e);
+        for (ArcId a=arcBegin(u); a<arcEnd(u); ++a) if (arcEdges[a]==e) return weights[a];
+        return 0.0;
+    }
+    // Writes both arcs of `e` and bumps version(). Returns the old weight.
+    double setEdgeWeight(EdgeId e, double w){
+        double old = 0.0;
+        double* writable = weights.writable();
+        for (NodeId u : {edgeTail(e), edgeHead(e)}){
+            for (ArcId a=arcBegin(u); a<arcEnd(u); ++a)
+                if (arcEdges[a]==e){ old = writable[a]; writable[a] = w; }
+        }
+        revision = nextRevision();
+        return old;
+    }
+    double edgeSpeed(EdgeId e) const { return edgeSpeeds[e]; }
+    double edgeToll(EdgeId e)  const { return edgeTolls[e]; }
+    bool isMapped() const { return targets.isMapped(); }
+
+    // Changes whenever the weights do (and differs between graphs built in
+    // one run), so derived results can be tagged with the version they saw.
+    uint64_t version() const { return revision; }
+
+    // FNV-1a over topology and weights; identifies the graph that derived
+    // data (landmark tables, caches on disk) was computed for.
+    uint64_t fingerprint() const {
+        uint64_t h = 1469598103934665603ull;
+        auto mix = [&](const void* data, size_t bytes){
+            const unsigned char* p = (const unsigned char*)data;
+            for (size_t i=0;i<bytes;++i){ h ^= p[i]; h *= 1099511628211ull; }
+        };
+        mix(offsets.data(), offsets.size()*sizeof(uint32_t));
+        mix(targets.data(), targets.size()*sizeof(NodeId));
+        mix(weights.data(), weights.size()*sizeof(double));
+        return h;
+    }
+
+    // f(target, weight) for every arc leaving u, in storage order.
+    template<class F> void forEachArc(NodeId u, F&& f) const {
+        for (ArcId a=offsets[u]; a<offsets[u+1]; ++a) f(targets[a], weights[a]);
+    }
+
+private:
+    friend class GraphFile;
+
+    Column<uint32_t> offsets;  // numNodes+1, arcs of u are [offsets[u], offsets[u+1])
+    Column<NodeId>   targets;
+    Column<double>   weights;
+    Column<EdgeId>   arcEdges; // undirected edge each arc belongs to
+    Column<NodeId>   edgeEnds; // tail/head pairs, one per undirected edge
+    Column<float>    edgeSpeeds;
+    Column<float>    edgeTolls;
+    uint64_t revision = 0;
+
+    static uint64_t nextRevision(){
+        static std::atomic<uint64_t> counter{0};
+        return ++counter;
+    }
+};
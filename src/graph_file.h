@@ -0,0 +1,271 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <filesystem>
+#include <algorithm>
+#include <type_traits>
+
+#include "graph.h"
+#include "contraction_hierarchy.h"
+#include "landmarks.h"
+#include "mapped_file.h"
+#include "parallel.h"
+
+// ---------------- Binary graph file ----------------
+// The network and its preprocessing in one file that is memory-mapped and
+// used in place: the CSR arrays, contraction hierarchy and landmark table
+// become views into the mapping (see Column), so opening takes the same time
+// for any graph and pages are read from disk as queries touch them.
+//
+// Layout, in native byte order:
+//   header         magic, format version, counts, graph fingerprint and a
+//                  checksum over the header and the section table
+//   section table  {id, offset, bytes, checksum} per section
+//   sections       each starting on a 64-byte boundary
+// Opening checks the header checksum and that every section has the size the
+// counts imply. Checksumming the sections themselves means reading the whole
+// file, so that only happens with verify = true.
+class GraphFile {
+public:
+    // What a file holds; hierarchy and landmarks stay empty if it has none.
+    struct Contents {
+        std::vector<Node> nodes;
+        std::vector<CsrGraph::NodeId> externalIds; // id in the source data of each node; empty if the same
+        CsrGraph graph;
+        ContractionHierarchy hierarchy;
+        LandmarkTable landmarks;
+        uint64_t fingerprint = 0; // graph.fingerprint() when it was written
+    };
+
+    // Writes to a temporary file first, so a failed save never leaves a
+    // half-written file under `path`. externalIds may be empty,
+    // hierarchy/landmarks null.
+    static bool save(const std::string& path, const std::vector<Node>& nodes, const std::vector<CsrGraph::NodeId>& externalIds,
+                     const CsrGraph& g, const ContractionHierarchy* hierarchy, const LandmarkTable* landmarks,
+                     std::string& error){
+        if (nodes.size() != g.numNodes() || (!externalIds.empty() && externalIds.size() != nodes.size())){
+            error = path + ": node list does not match the graph";
+            return false;
+        }
+        std::vector<float> xy;
+        std::vector<uint32_t> nameOffsets{0};
+        std::string names;
+        xy.reserve(2*nodes.size());
+        nameOffsets.reserve(nodes.size() + 1);
+        for (const Node& v : nodes){
+            xy.push_back(v.x); xy.push_back(v.y);
+            names += v.name;
+            if (names.size() >= CsrGraph::kInvalid){ error = path + ": node names too long"; return false; }
+            nameOffsets.push_back((uint32_t)names.size());
+        }
+
+        Header h{};
+        h.magic = kMagic; h.version = kVersion;
+        h.numNodes = g.numNodes(); h.numEdges = g.numEdges();
+        h.fingerprint = g.fingerprint();
+        std::vector<Blob> blobs;
+        auto add = [&](uint32_t id, const auto& column){
+            blobs.push_back({id, column.data(), column.size() * sizeof(column[0])});
+        };
+        add(NodeXY, xy); add(NameOffsets, nameOffsets); add(Names, names);
+        if (!externalIds.empty()) add(ExternalIds, externalIds);
+        add(Offsets, g.offsets); add(Targets, g.targets); add(Weights, g.weights); add(ArcEdges, g.arcEdges);
+        add(EdgeEnds, g.edgeEnds); add(EdgeSpeeds, g.edgeSpeeds); add(EdgeTolls, g.edgeTolls);
+        if (hierarchy && !hierarchy->empty()){
+            h.numShortcuts = hierarchy->shortcutCount();
+            add(ChRanks, hierarchy->ranks); add(ChOffsets, hierarchy->offsets); add(ChTargets, hierarchy->targets);
+            add(ChWeights, hierarchy->weights); add(ChMiddles, hierarchy->middles);
+        }
+        if (landmarks && landmarks->numLandmarks() > 0){
+            h.numLandmarks = landmarks->numLandmarks();
+            add(LandmarkIds, landmarks->landmarks); add(LandmarkRows, landmarks->table);
+        }
+
+        h.numSections = (uint32_t)blobs.size();
+        std::vector<Section> table(blobs.size());
+        uint64_t pos = align(sizeof(Header) + table.size()*sizeof(Section));
+        for (size_t i=0; i<blobs.size(); ++i){
+            table[i] = {blobs[i].id, 0, pos, blobs[i].bytes, 0};
+            pos = align(pos + blobs[i].bytes);
+        }
+        parallelFor(0, blobs.size(), [&](size_t i){ table[i].checksum = checksum(blobs[i].data, blobs[i].bytes); }, 1);
+        h.checksum = headerChecksum(h, table.data());
+
+        const std::string temp = path + ".tmp";
+        {
+            std::ofstream out(temp, std::ios::binary);
+            if (!out){ error = temp + ": cannot write"; return false; }
+            out.write((const char*)&h, sizeof(h));
+            out.write((const char*)table.data(), table.size()*sizeof(Section));
+            static const char zeros[kAlign] = {};
+            uint64_t at = sizeof(Header) + table.size()*sizeof(Section);
+            for (size_t i=0; i<blobs.size(); ++i){
+                out.write(zeros, (std::streamsize)(table[i].offset - at));
+                out.write((const char*)blobs[i].data, (std::streamsize)blobs[i].bytes);
+                at = table[i].offset + blobs[i].bytes;
+            }
+            if (!out){ error = temp + ": write failed"; return false; }
+        }
+        std::error_code ec;
+        std::filesystem::rename(temp, path, ec);
+        if (ec){ error = path + ": " + ec.message(); return false; }
+        return true;
+    }
+
+    // Maps `path` and points `out` into it. Only the node list (coordinates,
+    // names and external ids, which the app keeps in vectors) is copied.
+    static bool load(const std::string& path, Contents& out, std::string& error, bool verify = false){
+        auto file = std::make_shared<MappedFile>();
+        if (!file->open(path, MappedFile::Access::Random)){ error = path + ": cannot open"; return false; }
+        const char* base = file->data();
+        const uint64_t size = file->size();
+        auto fail = [&](const std::string& problem){ error = path + ": " + problem; return false; };
+
+        Header h;
+        if (size < sizeof(Header)) return fail("too short for a graph file");
+        std::memcpy(&h, base, sizeof(h));
+        if (h.magic != kMagic) return fail("not a graph file");
+        if (h.version != kVersion)
+            return fail("format version " + std::to_string(h.version) + ", expected " + std::to_string(kVersion));
+        if (h.numSections > kSectionCount || sizeof(Header) + (uint64_t)h.numSections*sizeof(Section) > size)
+            return fail("bad section table");
+        std::vector<Section> table(h.numSections);
+        std::memcpy(table.data(), base + sizeof(Header), table.size()*sizeof(Section));
+        if (headerChecksum(h, table.data()) != h.checksum) return fail("header checksum mismatch");
+
+        const Section* sections[kSectionCount] = {};
+        for (const Section& s : table){
+            if (s.id >= kSectionCount || sections[s.id] || s.offset % kAlign != 0 ||
+                s.offset > size || s.bytes > size - s.offset) return fail("bad section table");
+            sections[s.id] = &s;
+        }
+        if (verify){
+            std::vector<char> bad(table.size(), 0);
+            parallelFor(0, table.size(), [&](size_t i){
+                bad[i] = checksum(base + table[i].offset, table[i].bytes) != table[i].checksum;
+            }, 1);
+            for (size_t i=0; i<table.size(); ++i)
+                if (bad[i]) return fail("checksum mismatch in section " + std::to_string(table[i].id));
+        }
+
+        // Every section must be present with exactly the size the counts
+        // imply; arc counts come from the CSR offsets' last entry.
+        auto sized = [&](uint32_t id, uint64_t bytes){ return sections[id] && sections[id]->bytes == bytes; };
+        auto last = [&](uint32_t id, uint32_t count){
+            uint32_t v;
+            std::memcpy(&v, base + sections[id]->offset + (uint64_t)count*sizeof(uint32_t), sizeof(v));
+            return (uint64_t)v;
+        };
+        const uint64_t n = h.numNodes, m = h.numEdges;
+        if (n >= CsrGraph::kInvalid || !sized(Offsets, (n+1)*4)) return fail("bad graph arrays");
+        const uint64_t arcs = last(Offsets, h.numNodes);
+        if (!sized(Targets, arcs*4) || !sized(Weights, arcs*8) || !sized(ArcEdges, arcs*4) ||
+            !sized(EdgeEnds, m*8) || !sized(EdgeSpeeds, m*4) || !sized(EdgeTolls, m*4) || arcs != 2*m)
+            return fail("bad graph arrays");
+        if (!sized(NodeXY, n*8) || !sized(NameOffsets, (n+1)*4) || !sections[Names] ||
+            last(NameOffsets, h.numNodes) != sections[Names]->bytes) return fail("bad node table");
+
+        auto view = [&](uint32_t id, auto& column){
+            using T = std::decay_t<decltype(column[0])>;
+            const Section& s = *sections[id];
+            column = Column<T>((const T*)(base + s.offset), s.bytes / sizeof(T), file);
+        };
+        Contents c;
+        c.fingerprint = h.fingerprint;
+        c.graph.revision   = CsrGraph::nextRevision();
+        view(Offsets, c.graph.offsets);
+        view(Targets, c.graph.targets);
+        view(Weights, c.graph.weights);
+        view(ArcEdges, c.graph.arcEdges);
+        view(EdgeEnds, c.graph.edgeEnds);
+        view(EdgeSpeeds, c.graph.edgeSpeeds);
+        view(EdgeTolls, c.graph.edgeTolls);
+
+        const float* xy = (const float*)(base + sections[NodeXY]->offset);
+        const uint32_t* nameAt = (const uint32_t*)(base + sections[NameOffsets]->offset);
+        const char* names = base + sections[Names]->offset;
+        c.nodes.resize(n);
+        for (uint64_t v=0; v<n; ++v){
+            if (nameAt[v] > nameAt[v+1]) return fail("bad node table");
+            c.nodes[v] = Node(xy[2*v], xy[2*v+1], std::string(names + nameAt[v], names + nameAt[v+1]));
+        }
+        if (sections[ExternalIds]){
+            if (!sized(ExternalIds, n*4)) return fail("bad node table");
+            const uint32_t* ids = (const uint32_t*)(base + sections[ExternalIds]->offset);
+            c.externalIds.assign(ids, ids + n);
+        }
+
+        if (sections[ChRanks]){
+            if (!sized(ChRanks, n*4) || !sized(ChOffsets, (n+1)*4)) return fail("bad hierarchy arrays");
+            const uint64_t up = last(ChOffsets, h.numNodes);
+            if (!sized(ChTargets, up*4) || !sized(ChWeights, up*8) || !sized(ChMiddles, up*4))
+                return fail("bad hierarchy arrays");
+            ContractionHierarchy& ch = c.hierarchy;
+            view(ChRanks, ch.ranks);
+            view(ChOffsets, ch.offsets);
+            view(ChTargets, ch.targets);
+            view(ChWeights, ch.weights);
+            view(ChMiddles, ch.middles);
+            ch.numShortcuts = h.numShortcuts;
+        }
+        if (sections[LandmarkIds]){
+            const uint64_t k = h.numLandmarks;
+            if (!sized(LandmarkIds, k*4) || !sized(LandmarkRows, n*k*4)) return fail("bad landmark table");
+            LandmarkTable& t = c.landmarks;
+            const uint32_t* ids = (const uint32_t*)(base + sections[LandmarkIds]->offset);
+            t.numNodes = h.numNodes;
+            t.landmarks.assign(ids, ids + k);
+            view(LandmarkRows, t.table);
+        }
+        out = std::move(c);
+        return true;
+    }
+
+private:
+    static constexpr uint32_t kMagic   = 0x47464650; // "PFFG"
+    static constexpr uint32_t kVersion = 1;
+    static constexpr uint64_t kAlign   = 64;
+
+    enum : uint32_t { NodeXY, NameOffsets, Names, Offsets, Targets, Weights, ArcEdges, EdgeEnds, EdgeSpeeds,
+                      EdgeTolls, ChRanks, ChOffsets, ChTargets, ChWeights, ChMiddles, LandmarkIds, LandmarkRows,
+                      ExternalIds, kSectionCount };
+
+    struct Header {
+        uint32_t magic, version, numSections, numNodes;
+        uint32_t numEdges, numShortcuts, numLandmarks, reserved;
+        uint64_t fingerprint;
+        uint64_t checksum; // of this header (with checksum = 0) and the section table
+    };
+    struct Section {
+        uint32_t id, reserved;
+        uint64_t offset, bytes, checksum;
+    };
+    struct Blob { uint32_t id; const void* data; size_t bytes; };
+
+    static uint64_t align(uint64_t pos){ return (pos + kAlign - 1) / kAlign * kAlign; }
+
+    // Word-at-a-time multiply/xor-shift hash: catches torn writes and bit
+    // rot at memory speed; not meant to resist deliberate tampering.
+    static uint64_t checksum(const void* data, size_t bytes, uint64_t h = 0x9E3779B97F4A7C15ull){
+        const char* p = (const char*)data;
+        h ^= bytes;
+        size_t i = 0;
+        for (; i+8 <= bytes; i+=8){
+            uint64_t w;
+            std::memcpy(&w, p+i, 8);
+            h = (h ^ w) * 0xFF51AFD7ED558CCDull;
+            h ^= h >> 32;
+        }
+        for (; i<bytes; ++i){ h = (h ^ (uint8_t)p[i]) * 0xFF51AFD7ED558CCDull; h ^= h >> 32; }
+        return h;
+    }
+    static uint64_t headerChecksum(Header h, const Section* table){
+        h.checksum = 0;
+        return checksum(table, h.numSections*sizeof(Section), checksum(&h, sizeof(h)));
+    }
+};
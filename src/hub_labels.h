@@ -0,0 +1,181 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <limits>
+#include <cmath>
+#include <algorithm>
+
+#include "graph.h"
+#include "dijkstra.h"
+
+// ---------------- Hub labels ----------------
+// Every node keeps a label: (hub, distance) pairs such that any two nodes
+// share a hub on one of their shortest paths. d(s,t) is then the minimum of
+// d(s,h) + d(h,t) over hubs common to both labels, found by one linear merge.
+// Labels come from pruned landmark labeling: nodes are processed from most to
+// least important (a CH order works well) and each runs a Dijkstra that stops
+// wherever the labels built so far already give the right distance.
+//
+// All labels live in two flat arrays (hubs, dists), sorted by hub rank and
+// terminated by a sentinel hub, so the merge is a tight loop over contiguous
+// memory with no per-node allocation.
+class HubLabels {
+public:
+    using NodeId = CsrGraph::NodeId;
+    static constexpr double kInf = std::numeric_limits<double>::infinity();
+
+    HubLabels() = default;
+
+    // `order` lists every node, most important first.
+    static HubLabels build(const CsrGraph& g, const std::vector<NodeId>& order){
+        HubLabels hl;
+        const uint32_t n = g.numNodes();
+        std::vector<std::vector<std::pair<uint32_t,double>>> labels(n);
+        std::vector<double> hubDist(n, kInf); // d(root, h) for hubs in the root's label, by rank
+        QueryContext ctx;
+
+        for (uint32_t rank=0; rank<n; ++rank){
+            const NodeId root = order[rank];
+            for (const auto& [h, d] : labels[root]) hubDist[h] = d;
+            hubDist[rank] = 0.0;
+
+            ctx.reset(n);
+            ctx.setLabel((int)root, 0.0, -1);
+            ctx.push(0.0, (int)root);
+            while (!ctx.empty()){
+                auto [d, u] = ctx.pop();
+                if (d > ctx.dist(u)) continue;
+                // Prune: an earlier (more important) hub already covers root-u.
+                double known = kInf;
+                for (const auto& [h, dh] : labels[u]) known = std::min(known, hubDist[h] + dh);
+                if (known <= d) continue;
+
+                labels[u].push_back({rank, d});
+                g.forEachArc((NodeId)u, [&](NodeId v, double w){
+                    double nd = d + w;
+                    if (nd < ctx.dist((int)v)){ ctx.setLabel((int)v, nd, u); ctx.push(nd, (int)v); }
+                });
+            }
+
+            for (const auto& [h, d] : labels[root]) hubDist[h] = kInf;
+            hubDist[rank] = kInf;
+        }
+
+        hl.offsets.assign(n+1, 0);
+        for (NodeId v=0; v<n; ++v) hl.offsets[v+1] = hl.offsets[v] + (uint32_t)labels[v].size() + 1;
+        hl.hubs.reserve(hl.offsets[n]);
+        hl.dists.reserve(hl.offsets[n]);
+        for (NodeId v=0; v<n; ++v){
+            for (const auto& [h, d] : labels[v]){ hl.hubs.push_back(h); hl.dists.push_back(d); }
+            hl.hubs.push_back(kSentinel); hl.dists.push_back(kInf);
+            std::vector<std::pair<uint32_t,double>>().swap(labels[v]);
+        }
+        return hl;
+    }
+
+    uint32_t numNodes() const { return offsets.empty() ? 0 : (uint32_t)offsets.size()-1; }
+    size_t numEntries() const { return hubs.size() - numNodes(); } // without sentinels
+    size_t sizeBytes() const {
+        return offsets.size()*sizeof(uint32_t) + hubs.size()*sizeof(uint32_t) + dists.size()*sizeof(double);
+    }
+    uint32_t labelSize(NodeId v) const { return offsets[v+1] - offsets[v] - 1; }
+
+    // Merge of the two sorted labels. Both cursors advance with comparisons
+    // instead of branches; the shared sentinel ends the loop.
+    double distance(NodeId s, NodeId t) const {
+        const uint32_t* hs = &hubs[offsets[s]];
+        const uint32_t* ht = &hubs[offsets[t]];
+        const double*   ds = &dists[offsets[s]];
+        const double*   dt = &dists[offsets[t]];
+        double best = kInf;
+        size_t i = 0, j = 0;
+        for (;;){
+            const uint32_t a = hs[i], b = ht[j];
+            if (a == b){
+                if (a == kSentinel) break;
+                best = std::min(best, ds[i] + dt[j]);
+            }
+            i += (a <= b);
+            j += (b <= a);
+        }
+        return best;
+    }
+
+    // Optional path retrieval: from s, repeatedly step to a neighbour that
+    // keeps w(s,v) + d(v,t) == d(s,t) and gets closer to t. Zero-weight roads
+    // can leave cur on a plateau of nodes all as far from t; it is crossed
+    // breadth-first to the nearest node with such a step. d(cur,t) falls on
+    // every step, so the walk cannot cycle. Costs one label merge per arc
+    // looked at, so distance-only callers should stick to distance().
+    std::vector<int> path(const CsrGraph& g, NodeId s, NodeId t) const {
+        std::vector<int> out;
+        double remaining = distance(s, t);
+        if (remaining == kInf) return out;
+        const double tolerance = 1e-9 * std::max(1.0, remaining);
+        auto tight = [&](CsrGraph::ArcId a, double rest, double left){
+            return std::fabs(g.arcWeight(a) + rest - left) <= tolerance;
+        };
+        // Best step from u when d(u,t) is `left`: t itself if an arc reaches
+        // it, otherwise the tightest arc to a node closer to t.
+        auto step = [&](NodeId u, double left, double& nextRest){
+            NodeId next = CsrGraph::kInvalid; double bestErr = kInf;
+            for (auto a=g.arcBegin(u); a<g.arcEnd(u); ++a){
+                const NodeId v = g.arcTarget(a);
+                const double rest = distance(v, t);
+                if (!tight(a, rest, left)) continue;
+                if (v == t){ nextRest = rest; return v; }
+                const double err = std::fabs(g.arcWeight(a) + rest - left);
+                if (rest < left && err < bestErr){ bestErr = err; next = v; nextRest = rest; }
+            }
+            return next;
+        };
+
+        out.push_back((int)s);
+        NodeId cur = s;
+        std::vector<NodeId> plateau;
+        std::vector<uint32_t> reachedFrom; // index into plateau
+        // Plateau membership by generation stamp, reused across calls on
+        // this thread, so a crossing costs O(plateau) and no clear.
+        thread_local std::vector<uint32_t> onPlateau;
+        thread_local uint32_t generation = 0;
+        if (onPlateau.size() < g.numNodes()) onPlateau.resize(g.numNodes(), 0);
+        while (cur != t){
+            double nextRemaining = kInf;
+            NodeId next = step(cur, remaining, nextRemaining);
+            if (next == CsrGraph::kInvalid){
+                if (++generation == 0){ std::fill(onPlateau.begin(), onPlateau.end(), 0); generation = 1; }
+                plateau.assign(1, cur);
+                reachedFrom.assign(1, 0);
+                onPlateau[cur] = generation;
+                size_t exit = 0;
+                for (size_t i=0; i<plateau.size() && next == CsrGraph::kInvalid; ++i){
+                    for (auto a=g.arcBegin(plateau[i]); a<g.arcEnd(plateau[i]); ++a){
+                        const NodeId v = g.arcTarget(a);
+                        if (onPlateau[v] == generation) continue;
+                        if (!tight(a, distance(v, t), remaining)) continue;
+                        onPlateau[v] = generation;
+                        plateau.push_back(v);
+                        reachedFrom.push_back((uint32_t)i);
+                        next = step(v, remaining, nextRemaining);
+                        if (next != CsrGraph::kInvalid){ exit = plateau.size() - 1; break; }
+                    }
+                }
+                if (next == CsrGraph::kInvalid) return {};
+                const size_t joined = out.size();
+                for (size_t i=exit; i!=0; i=reachedFrom[i]) out.push_back((int)plateau[i]);
+                std::reverse(out.begin() + joined, out.end());
+            }
+            out.push_back((int)next);
+            cur = next; remaining = nextRemaining;
+        }
+        return out;
+    }
+
+private:
+    static constexpr uint32_t kSentinel = ~0u;
+
+    std::vector<uint32_t> offsets; // label of v is [offsets[v], offsets[v+1]), sentinel last
+    std::vector<uint32_t> hubs;    // hub ranks, ascending within a label
+    std::vector<double>   dists;
+};
@@ -0,0 +1,268 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <utility>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+#include <functional>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#include "graph.h"
+#include "dijkstra.h"
+
+// ---------------- Integer-weight Dijkstra ----------------
+// Dijkstra on weights quantized to 32-bit fixed point (say metres or
+// seconds), with labels to match: an arc costs 8 bytes to scan instead of
+// 12, a label 4 instead of 8, and the priority queue can exploit integer
+// keys. The queue is a template policy, chosen at compile time:
+//   BinaryHeapQueue  the same lazy binary heap QueryContext uses
+//   RadixHeap        monotone radix heap, 33 buckets by highest differing bit
+//   DialQueue        one bucket per distance value, cycled; needs the largest
+//                    arc weight, so it suits coarse units
+// Quantizing rounds each arc by at most half a unit, so a route can be off
+// by half a unit per arc against the double search.
+
+// ---------------- Quantized graph ----------------
+// CsrGraph topology seen through per-edge weights rounded to integers; only
+// the arc weights are stored, the topology is the graph's own.
+class QuantizedGraph {
+public:
+    QuantizedGraph() = default;
+
+    // Multiplies every edge weight by `unitsPerWeight` and rounds it. Fails
+    // (saying why in `error`) on negative or non-finite weights, and unless
+    // the sum over all edges plus the heaviest one stays below the integer
+    // infinity: a label is a simple path plus at most one more arc, so
+    // searches then never overflow.
+    static bool build(const CsrGraph& g, const std::vector<double>& edgeWeights, double unitsPerWeight,
+                      QuantizedGraph& out, std::string& error){
+        if (edgeWeights.size() != g.numEdges()){ error = "weights do not match the graph"; return false; }
+        std::vector<uint32_t> edgeUnits(edgeWeights.size());
+        uint64_t total = 0, heaviest = 0;
+        for (size_t e=0; e<edgeWeights.size(); ++e){
+            const double units = std::round(edgeWeights[e] * unitsPerWeight);
+            if (!(units >= 0.0)){ error = "edge " + std::to_string(e) + " has a negative or invalid weight"; return false; }
+            const uint64_t rounded = (uint64_t)std::min(units, 4294967296.0);
+            total += rounded;
+            heaviest = std::max(heaviest, rounded);
+            if (total + heaviest >= kInf){
+                error = "total weight exceeds 32 bits at this scale";
+                return false;
+            }
+            edgeUnits[e] = (uint32_t)rounded;
+        }
+        QuantizedGraph q;
+        q.g = &g;
+        q.scale = unitsPerWeight;
+        q.weights.resize(g.numArcs());
+        for (CsrGraph::ArcId a=0; a<g.numArcs(); ++a){
+            q.weights[a] = edgeUnits[g.arcEdge(a)];
+            q.maxWeight = std::max(q.maxWeight, q.weights[a]);
+        }
+        out = std::move(q);
+        return true;
+    }
+
+    static constexpr uint32_t kInf = ~0u;
+
+    bool empty() const { return g == nullptr; }
+    uint32_t numNodes() const { return g->numNodes(); }
+    uint32_t maxArcWeight() const { return maxWeight; }
+    double unitsPerWeight() const { return scale; }
+    double toWeight(uint32_t units) const { return units / scale; }
+    size_t sizeBytes() const { return weights.size() * sizeof(uint32_t); }
+
+    template<class F> void forEachArc(CsrGraph::NodeId u, F&& f) const {
+        for (auto a=g->arcBegin(u); a<g->arcEnd(u); ++a) f(g->arcTarget(a), weights[a]);
+    }
+
+private:
+    const CsrGraph* g = nullptr;
+    std::vector<uint32_t> weights; // per arc
+    uint32_t maxWeight = 0;
+    double scale = 1.0;
+};
+
+// ---------------- Queue policies ----------------
+// Each holds (key, node) entries with lazy deletion like QueryContext's
+// heap: the search skips entries whose key no longer matches the label.
+// reset() gets the largest arc weight of the graph about to be searched.
+class BinaryHeapQueue {
+public:
+    void reset(uint32_t){ heap.clear(); }
+    void push(uint32_t key, int v){
+        heap.push_back({key, v});
+        std::push_heap(heap.begin(), heap.end(), std::greater<>());
+    }
+    std::pair<uint32_t, int> pop(){
+        std::pop_heap(heap.begin(), heap.end(), std::greater<>());
+        auto top = heap.back(); heap.pop_back();
+        return top;
+    }
+    bool empty() const { return heap.empty(); }
+
+private:
+    std::vector<std::pair<uint32_t, int>> heap;
+};
+
+// Keys must never be below the last popped one, which Dijkstra guarantees.
+// Bucket i holds keys whose highest bit differing from that key is bit
+// i-1; popping from an empty bucket 0 redistributes the first non-empty
+// bucket around its minimum, so each entry moves at most 32 times.
+class RadixHeap {
+public:
+    void reset(uint32_t){
+        for (auto& b : buckets) b.clear();
+        last = 0; count = 0;
+    }
+    void push(uint32_t key, int v){
+        buckets[bucketOf(key)].push_back({key, v});
+        ++count;
+    }
+    std::pair<uint32_t, int> pop(){
+        if (buckets[0].empty()){
+            size_t i = 1;
+            while (buckets[i].empty()) ++i;
+            last = buckets[i][0].first;
+            for (const auto& e : buckets[i]) last = std::min(last, e.first);
+            for (const auto& e : buckets[i]) buckets[bucketOf(e.first)].push_back(e);
+            buckets[i].clear();
+        }
+        auto top = buckets[0].back(); buckets[0].pop_back();
+        --count;
+        return top;
+    }
+    bool empty() const { return count == 0; }
+
+private:
+    static uint32_t bitWidth(uint32_t x){
+#if defined(_MSC_VER)
+        unsigned long index;
+        return _BitScanReverse(&index, x) ? (uint32_t)index + 1 : 0;
+#else
+        return x ? 32 - (uint32_t)__builtin_clz(x) : 0;
+#endif
+    }
+    uint32_t bucketOf(uint32_t key) const { return bitWidth(key ^ last); }
+
+    std::vector<std::pair<uint32_t, int>> buckets[33];
+    uint32_t last = 0;
+    size_t count = 0;
+};
+
+// Dial's buckets: live keys span at most the largest arc weight C, so a
+// ring of more than C buckets never holds two distances in one bucket.
+// Popping scans forward from the last key, O(1) amortised per distance
+// value; meant for C up to some tens of thousands.
+class DialQueue {
+public:
+    void reset(uint32_t maxArcWeight){
+        size_t size = 1;
+        while (size <= maxArcWeight) size *= 2;
+        if (buckets.size() != size) buckets.assign(size, {});
+        else if (count > 0) for (auto& b : buckets) b.clear(); // left over by a search that stopped early
+        mask = size - 1; current = 0; count = 0;
+    }
+    void push(uint32_t key, int v){
+        buckets[key & mask].push_back({key, v});
+        ++count;
+    }
+    std::pair<uint32_t, int> pop(){
+        while (buckets[current & mask].empty()) ++current;
+        auto& b = buckets[current & mask];
+        auto top = b.back(); b.pop_back();
+        --count;
+        return top;
+    }
+    bool empty() const { return count == 0; }
+
+private:
+    std::vector<std::vector<std::pair<uint32_t, int>>> buckets;
+    size_t mask = 0;
+    uint32_t current = 0;
+    size_t count = 0;
+};
+
+// ---------------- Integer query state ----------------
+// QueryContext with 32-bit labels and the queue as a policy; same
+// generation stamps, so reset() does not touch every label.
+template<class Queue>
+class IntegerQueryContext {
+public:
+    static constexpr uint32_t kInf = QuantizedGraph::kInf;
+
+    void reset(size_t numNodes, uint32_t maxArcWeight){
+        if (stamps.size() < numNodes){
+            distance.resize(numNodes);
+            parents.resize(numNodes);
+            stamps.resize(numNodes, 0);
+        }
+        if (++generation == 0){
+            std::fill(stamps.begin(), stamps.end(), 0u);
+            generation = 1;
+        }
+        queue.reset(maxArcWeight);
+        stats = QueryStats{};
+    }
+
+    bool reached(int v) const { return stamps[v] == generation; }
+    uint32_t dist(int v) const { return reached(v) ? distance[v] : kInf; }
+    int parent(int v) const { return reached(v) ? parents[v] : -1; }
+    void setLabel(int v, uint32_t d, int p){ distance[v] = d; parents[v] = p; stamps[v] = generation; }
+
+    std::vector<int> pathTo(int target) const {
+        std::vector<int> path;
+        if (!reached(target)) return path;
+        for (int cur=target; cur!=-1; cur=parents[cur]) path.push_back(cur);
+        std::reverse(path.begin(), path.end());
+        return path;
+    }
+
+    Queue queue;
+    QueryStats stats;
+
+private:
+    std::vector<uint32_t> distance;
+    std::vector<int>      parents;
+    std::vector<uint32_t> stamps;
+    uint32_t generation = 0;
+};
+
+template<class Queue>
+IntegerQueryContext<Queue>& threadIntegerQueryContext(){
+    thread_local IntegerQueryContext<Queue> ctx;
+    return ctx;
+}
+
+// Point-to-point Dijkstra on integer weights; stops once `target` is
+// settled (-1 settles everything reachable). Returns dist(target) in
+// units, or kInf if unreachable. Graph needs numNodes(), maxArcWeight()
+// and forEachArc(u, f(v, uint32_t w)) (see QuantizedGraph).
+template<class Queue, class Graph>
+uint32_t integerDijkstra(const Graph& g, int source, int target, IntegerQueryContext<Queue>& ctx){
+    ctx.reset(g.numNodes(), g.maxArcWeight());
+    ctx.setLabel(source, 0, -1);
+    ctx.queue.push(0, source);
+
+    while (!ctx.queue.empty()){
+        auto [key, u] = ctx.queue.pop();
+        const uint32_t d = ctx.dist(u);
+        if (key > d) continue; // stale entry
+        ++ctx.stats.settled;
+        if (u == target) return d;
+        g.forEachArc(u, [&](uint32_t v, uint32_t w){
+            ++ctx.stats.relaxed;
+            const uint32_t nd = d + w;
+            if (nd < ctx.dist((int)v)){
+                ctx.setLabel((int)v, nd, u);
+                ctx.queue.push(nd, (int)v);
+            }
+        });
+    }
+    return target >= 0 ? ctx.dist(target) : IntegerQueryContext<Queue>::kInf;
+}
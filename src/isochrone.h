@@ -0,0 +1,140 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <limits>
+#include <algorithm>
+#include <functional>
+
+#include "graph.h"
+
+// ---------------- Isochrones ----------------
+// Everything reachable from a source within a budget of some per-edge metric
+// (hours, BDT, ...). The search is a Dijkstra that stops at the budget but
+// keeps its heap, so a larger budget resumes where the last one stopped and a
+// smaller one is a prefix of the settle order. Dragging the budget back and
+// forth therefore costs at most one search up to the largest value seen.
+class Isochrone {
+public:
+    using NodeId = CsrGraph::NodeId;
+    using EdgeId = CsrGraph::EdgeId;
+    static constexpr double kInf = std::numeric_limits<double>::infinity();
+
+    // Part of an edge inside the budget: from `from` towards `to`, covering
+    // `fraction` of its length (1 = the whole edge).
+    struct Segment {
+        NodeId from, to;
+        double fraction;
+    };
+
+    // Starts a new search; `weights` is per EdgeId and must outlive the
+    // isochrone (or the next reset).
+    void reset(const CsrGraph& g, const std::vector<double>& weights, NodeId source){
+        graph = &g;
+        edgeWeights = &weights;
+        root = source;
+        version = g.version();
+        distance.assign(g.numNodes(), kInf);
+        order.clear();
+        heap.clear();
+        reached = -1.0;
+        distance[source] = 0.0;
+        heap.push_back({0.0, source});
+    }
+
+    bool empty() const { return graph == nullptr; }
+    NodeId source() const { return root; }
+    uint64_t graphVersion() const { return version; }
+    const std::vector<double>* weights() const { return edgeWeights; }
+    double dist(NodeId v) const { return distance[v]; } // exact up to the largest budget searched
+
+    // Settles every node within `budget` that is not settled yet.
+    void extendTo(double budget){
+        if (budget <= reached) return;
+        const CsrGraph& g = *graph;
+        while (!heap.empty() && heap.front().first <= budget){
+            std::pop_heap(heap.begin(), heap.end(), std::greater<>());
+            auto [d, u] = heap.back(); heap.pop_back();
+            if (d > distance[u]) continue; // stale entry
+            order.push_back(u);
+            for (auto a=g.arcBegin(u); a<g.arcEnd(u); ++a){
+                const NodeId v = g.arcTarget(a);
+                const double nd = d + (*edgeWeights)[g.arcEdge(a)];
+                if (nd < distance[v]){
+                    distance[v] = nd;
+                    heap.push_back({nd, v});
+                    std::push_heap(heap.begin(), heap.end(), std::greater<>());
+                }
+            }
+        }
+        reached = budget;
+    }
+
+    // Nodes within `budget`, nearest first; extendTo(budget) must have run.
+    std::vector<NodeId> nodesWithin(double budget) const {
+        auto end = std::upper_bound(order.begin(), order.end(), budget,
+                                    [&](double b, NodeId v){ return b < distance[v]; });
+        return std::vector<NodeId>(order.begin(), end);
+    }
+
+    // Reachable part of every edge touching the isochrone. An edge whose two
+    // ends are both inside is whole when the budget left at its ends covers
+    // its length, otherwise each end contributes the stretch it can reach.
+    std::vector<Segment> segmentsWithin(double budget) const {
+        const CsrGraph& g = *graph;
+        std::vector<Segment> out;
+        for (NodeId u : nodesWithin(budget)){
+            const double leftU = budget - distance[u];
+            for (auto a=g.arcBegin(u); a<g.arcEnd(u); ++a){
+                const NodeId v = g.arcTarget(a);
+                const double w = (*edgeWeights)[g.arcEdge(a)];
+                const double leftV = distance[v] <= budget ? budget - distance[v] : -1.0;
+                if (leftV >= 0.0 && leftU + leftV >= w){
+                    if (u <= v) out.push_back({u, v, 1.0}); // whole edge, once
+                } else if (leftU > 0.0 || w == 0.0){
+                    out.push_back({u, v, w > 0.0 ? std::min(1.0, leftU / w) : 1.0});
+                }
+            }
+        }
+        return out;
+    }
+
+    size_t sizeBytes() const {
+        return distance.size()*sizeof(double) + order.size()*sizeof(NodeId) + heap.size()*sizeof(heap[0]);
+    }
+
+private:
+    const CsrGraph* graph = nullptr;
+    const std::vector<double>* edgeWeights = nullptr;
+    NodeId root = 0;
+    uint64_t version = 0;
+    double reached = -1.0;              // largest budget searched so far
+    std::vector<double> distance;
+    std::vector<NodeId> order;          // settled nodes by distance
+    std::vector<std::pair<double, NodeId>> heap;
+};
+
+// Convex hull (counter-clockwise, no collinear points) of `points`, by
+// Andrew's monotone chain. Used to shade the area an isochrone covers.
+template<class Point>
+std::vector<Point> convexHull(std::vector<Point> points){
+    std::sort(points.begin(), points.end(), [](const Point& a, const Point& b){
+        return a.x < b.x || (a.x == b.x && a.y < b.y);
+    });
+    if (points.size() < 3) return points;
+    auto cross = [](const Point& o, const Point& a, const Point& b){
+        return (double)(a.x - o.x) * (b.y - o.y) - (double)(a.y - o.y) * (b.x - o.x);
+    };
+    std::vector<Point> hull(2 * points.size());
+    size_t k = 0;
+    for (size_t i=0; i<points.size(); ++i){ // lower half
+        while (k >= 2 && cross(hull[k-2], hull[k-1], points[i]) <= 0) --k;
+        hull[k++] = points[i];
+    }
+    for (size_t i=points.size()-1, lower=k+1; i-- > 0; ){ // upper half
+        while (k >= lower && cross(hull[k-2], hull[k-1], points[i]) <= 0) --k;
+        hull[k++] = points[i];
+    }
+    hull.resize(k - 1);
+    return hull;
+}
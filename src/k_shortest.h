@@ -0,0 +1,153 @@
+#pragma once
+
+#include <vector>
+#include <set>
+#include <cstdint>
+#include <algorithm>
+
+#include "graph.h"
+#include "dijkstra.h"
+#include "parallel.h"
+
+// ---------------- K shortest simple paths ----------------
+// Yen's algorithm: path i+1 is the best "spur" deviation from one of the
+// first i paths, where a spur from node p[j] keeps the root p[0..j], may not
+// revisit the root, and may not leave p[j] the way an earlier path with the
+// same root did.
+//
+// Spur searches are cheap because of one search from the target at the start:
+//  - its distances d(v, t) are exact on the full graph and a lower bound once
+//    nodes and edges are blocked, i.e. a perfect A* potential for every spur;
+//  - when the tree path from the spur node to t avoids everything blocked,
+//    it is the spur path and no search is needed at all.
+// The spurs of one path are independent and run in parallel.
+struct RankedPath {
+    std::vector<int> path;
+    double distance = 0.0;
+};
+
+class KShortestPaths {
+public:
+    // Up to k loopless s-t paths, shortest first.
+    static std::vector<RankedPath> find(const CsrGraph& g, int source, int target, uint32_t k){
+        KShortestPaths ksp(g, target);
+        return ksp.run(source, k);
+    }
+
+private:
+    using NodeId = CsrGraph::NodeId;
+
+    KShortestPaths(const CsrGraph& g_, int target_) : g(g_), target(target_) {
+        QueryContext ctx;
+        dijkstra(g, target, -1, ctx); // undirected: distances to t = distances from t
+        toTarget.resize(g.numNodes());
+        nextHop.resize(g.numNodes());
+        for (NodeId v=0; v<g.numNodes(); ++v){ toTarget[v] = ctx.dist((int)v); nextHop[v] = ctx.parent((int)v); }
+    }
+
+    // The graph minus the blocked nodes and the blocked first hops of the spur.
+    struct SpurGraph {
+        const CsrGraph* g;
+        const std::vector<uint32_t>* nodeStamps; uint32_t stamp;
+        int spur;
+        const std::vector<int>* blockedHops; // neighbours of `spur` it may not step to
+
+        uint32_t numNodes() const { return g->numNodes(); }
+        template<class F> void forEachArc(NodeId u, F&& f) const {
+            for (auto a=g->arcBegin(u); a<g->arcEnd(u); ++a){
+                NodeId v = g->arcTarget(a);
+                if ((*nodeStamps)[v] == stamp) continue;
+                if ((int)u == spur && std::find(blockedHops->begin(), blockedHops->end(), (int)v) != blockedHops->end()) continue;
+                f(v, g->arcWeight(a));
+            }
+        }
+    };
+    struct TargetPotential {
+        const std::vector<double>* toTarget;
+        double operator()(int v) const { return (*toTarget)[v]; }
+    };
+
+    // Per-thread blocked-node marks; a fresh stamp per spur clears them.
+    struct Scratch {
+        std::vector<uint32_t> stamps;
+        uint32_t stamp = 0;
+    };
+    static Scratch& threadScratch(){
+        thread_local Scratch s;
+        return s;
+    }
+
+    double arcCost(int u, int v) const {
+        double best = QueryContext::kInf;
+        for (auto a=g.arcBegin(u); a<g.arcEnd(u); ++a) if ((int)g.arcTarget(a) == v) best = std::min(best, g.arcWeight(a));
+        return best;
+    }
+
+    // Best deviation at position j of `prev`; empty path if there is none.
+    RankedPath spur(const RankedPath& prev, size_t j, const std::vector<double>& prefix,
+                    const std::vector<RankedPath>& accepted) const {
+        const int s = prev.path[j];
+        std::vector<int> blockedHops;
+        for (const auto& p : accepted)
+            if (p.path.size() > j+1 && std::equal(p.path.begin(), p.path.begin()+j+1, prev.path.begin()))
+                blockedHops.push_back(p.path[j+1]);
+
+        Scratch& sc = threadScratch();
+        if (sc.stamps.size() < g.numNodes()) sc.stamps.assign(g.numNodes(), 0);
+        if (++sc.stamp == 0){ std::fill(sc.stamps.begin(), sc.stamps.end(), 0u); sc.stamp = 1; }
+        for (size_t i=0; i<j; ++i) sc.stamps[prev.path[i]] = sc.stamp;
+
+        RankedPath out;
+        // Tree path first: valid unless it touches the root or a blocked hop.
+        bool treeOk = toTarget[s] != QueryContext::kInf &&
+                      std::find(blockedHops.begin(), blockedHops.end(), nextHop[s]) == blockedHops.end();
+        for (int v=s; treeOk && v!=-1; v=nextHop[v]) if (sc.stamps[v] == sc.stamp) treeOk = false;
+        if (treeOk){
+            for (int v=s; v!=-1; v=nextHop[v]) out.path.push_back(v);
+            out.distance = prefix[j] + toTarget[s];
+        } else {
+            QueryContext& ctx = threadQueryContext();
+            SpurGraph sg{&g, &sc.stamps, sc.stamp, s, &blockedHops};
+            double d = astar(sg, s, target, ctx, TargetPotential{&toTarget});
+            if (d == QueryContext::kInf) return out;
+            out.path = ctx.pathTo(target);
+            out.distance = prefix[j] + d;
+        }
+        out.path.insert(out.path.begin(), prev.path.begin(), prev.path.begin()+j);
+        return out;
+    }
+
+    std::vector<RankedPath> run(int source, uint32_t k){
+        std::vector<RankedPath> accepted;
+        if (k == 0 || toTarget[source] == QueryContext::kInf) return accepted;
+        RankedPath first;
+        for (int v=source; v!=-1; v=nextHop[v]) first.path.push_back(v);
+        first.distance = toTarget[source];
+        accepted.push_back(first);
+
+        std::vector<RankedPath> candidates;
+        std::set<std::vector<int>> seen{first.path};
+        while (accepted.size() < k){
+            const RankedPath prev = accepted.back();
+            std::vector<double> prefix(prev.path.size(), 0.0);
+            for (size_t i=1; i<prev.path.size(); ++i) prefix[i] = prefix[i-1] + arcCost(prev.path[i-1], prev.path[i]);
+
+            std::vector<RankedPath> spurs(prev.path.size() > 1 ? prev.path.size()-1 : 0);
+            parallelFor(0, spurs.size(), [&](size_t j){ spurs[j] = spur(prev, j, prefix, accepted); }, 1);
+            for (auto& p : spurs)
+                if (!p.path.empty() && seen.insert(p.path).second) candidates.push_back(std::move(p));
+
+            if (candidates.empty()) break;
+            auto best = std::min_element(candidates.begin(), candidates.end(),
+                                         [](const RankedPath& a, const RankedPath& b){ return a.distance < b.distance; });
+            accepted.push_back(std::move(*best));
+            candidates.erase(best);
+        }
+        return accepted;
+    }
+
+    const CsrGraph& g;
+    int target;
+    std::vector<double> toTarget; // d(v, t)
+    std::vector<int>    nextHop;  // next node from v towards t, -1 at t
+};
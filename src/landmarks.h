@@ -0,0 +1,227 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cmath>
+#include <limits>
+#include <fstream>
+#include <algorithm>
+#include <numeric>
+
+#include "graph.h"
+#include "dijkstra.h"
+
+// ---------------- ALT landmarks ----------------
+// For a landmark L the triangle inequality gives |d(L,t) - d(L,v)| <= d(v,t)
+// on an undirected graph; the maximum over all landmarks is an A* potential
+// that follows road distance, not the straight line, so rivers and detours
+// do not fool it. Distances are kept as float, node-major (all landmarks of a
+// node in one row), which halves the table and keeps a lookup in one line.
+class LandmarkTable {
+public:
+    enum class Selection { Farthest, Avoid };
+
+    static constexpr float kUnreachable = std::numeric_limits<float>::infinity();
+
+    LandmarkTable() = default;
+
+    // Picks up to `k` landmarks and runs one full search from each.
+    static LandmarkTable build(const CsrGraph& g, uint32_t k, Selection selection){
+        LandmarkTable t;
+        const uint32_t n = g.numNodes();
+        k = std::min(k, n);
+        t.numNodes = n;
+        if (k == 0) return t;
+        QueryContext ctx;
+
+        if (selection == Selection::Farthest){
+            // Start far from node 0, then keep taking the node farthest from
+            // every landmark chosen so far (unreached nodes count as farthest,
+            // so each component gets a landmark).
+            std::vector<double> nearest(n, QueryContext::kInf);
+            NodeId next = farthestFrom(g, 0, ctx);
+            while (t.landmarks.size() < k){
+                t.addLandmark(g, next, ctx);
+                double bestDist = -1.0;
+                for (NodeId v=0; v<n; ++v){
+                    nearest[v] = std::min(nearest[v], ctx.dist((int)v));
+                    bool taken = std::find(t.landmarks.begin(), t.landmarks.end(), v) != t.landmarks.end();
+                    if (!taken && nearest[v] > bestDist){ bestDist = nearest[v]; next = v; }
+                }
+            }
+        } else {
+            t.addLandmark(g, farthestFrom(g, 0, ctx), ctx);
+            // Roots are drawn pseudo-randomly; a root whose tree is already
+            // covered yields nothing, so allow a few misses per landmark.
+            uint32_t seed = 0x9E3779B9u;
+            for (uint32_t attempt=0; t.landmarks.size() < k && attempt < 8*k; ++attempt){
+                seed = seed*1664525u + 1013904223u;
+                NodeId next = t.avoidPick(g, seed % n, ctx);
+                if (next != CsrGraph::kInvalid) t.addLandmark(g, next, ctx);
+            }
+        }
+        t.transpose();
+        return t;
+    }
+
+    uint32_t numLandmarks() const { return (uint32_t)landmarks.size(); }
+    uint32_t landmark(uint32_t i) const { return landmarks[i]; }
+    const float* row(uint32_t v) const { return &table[(size_t)v*landmarks.size()]; }
+    size_t sizeBytes() const { return table.size()*sizeof(float) + landmarks.size()*sizeof(uint32_t); }
+
+    // Max-over-landmarks lower bound on d(u, v).
+    double lowerBound(uint32_t u, uint32_t v) const {
+        return bound(row(u), row(v), numLandmarks());
+    }
+
+    static double bound(const float* a, const float* b, uint32_t k){
+        double best = 0.0;
+        for (uint32_t i=0; i<k; ++i){
+            if (a[i] == kUnreachable || b[i] == kUnreachable) continue;
+            // Float storage may be off by half an ulp either way; subtracting
+            // the worst case keeps the bound admissible.
+            double slack = ((double)a[i] + (double)b[i]) * (1.0/(1u<<23));
+            best = std::max(best, std::fabs((double)a[i] - (double)b[i]) - slack);
+        }
+        return best;
+    }
+
+    // ---- persistence ----
+    // Layout: magic, version, node count, k, graph fingerprint, landmark ids,
+    // then the node-major float table. Loading fails (returns false), leaving
+    // `t` untouched, when the file was made for a different graph or holds
+    // more landmarks than nodes or an id that is not a node.
+    bool save(const std::string& path, uint64_t graphFingerprint) const {
+        std::ofstream out(path, std::ios::binary);
+        if (!out) return false;
+        const uint32_t header[4] = { kMagic, kVersion, numNodes, numLandmarks() };
+        out.write((const char*)header, sizeof(header));
+        out.write((const char*)&graphFingerprint, sizeof(graphFingerprint));
+        out.write((const char*)landmarks.data(), landmarks.size()*sizeof(uint32_t));
+        out.write((const char*)table.data(), table.size()*sizeof(float));
+        return (bool)out;
+    }
+
+    static bool load(const std::string& path, uint64_t graphFingerprint, uint32_t expectedNodes, LandmarkTable& t){
+        std::ifstream in(path, std::ios::binary);
+        if (!in) return false;
+        uint32_t header[4] = {};
+        uint64_t fingerprint = 0;
+        in.read((char*)header, sizeof(header));
+        in.read((char*)&fingerprint, sizeof(fingerprint));
+        if (!in || header[0] != kMagic || header[1] != kVersion || header[2] != expectedNodes ||
+            header[3] > expectedNodes || fingerprint != graphFingerprint) return false;
+        std::vector<uint32_t> landmarks(header[3]);
+        in.read((char*)landmarks.data(), landmarks.size()*sizeof(uint32_t));
+        if (!in) return false;
+        for (uint32_t l : landmarks) if (l >= expectedNodes) return false;
+        std::vector<float> table((size_t)header[2]*header[3]);
+        in.read((char*)table.data(), table.size()*sizeof(float));
+        if (!in) return false;
+        t.numNodes = header[2];
+        t.landmarks = std::move(landmarks);
+        t.table = std::move(table);
+        return true;
+    }
+
+private:
+    using NodeId = CsrGraph::NodeId;
+    static constexpr uint32_t kMagic   = 0x4D4C4650; // "PFLM"
+    static constexpr uint32_t kVersion = 1;
+
+    static NodeId farthestFrom(const CsrGraph& g, NodeId source, QueryContext& ctx){
+        dijkstra(g, (int)source, -1, ctx);
+        NodeId best = source; double bestDist = 0.0;
+        for (NodeId v=0; v<g.numNodes(); ++v){
+            double d = ctx.dist((int)v);
+            if (d != QueryContext::kInf && d > bestDist){ bestDist = d; best = v; }
+        }
+        return best;
+    }
+
+    // Runs the search from L; its labels stay in ctx for the caller.
+    void addLandmark(const CsrGraph& g, NodeId L, QueryContext& ctx){
+        landmarks.push_back(L);
+        dijkstra(g, (int)L, -1, ctx);
+        for (NodeId v=0; v<numNodes; ++v){
+            double d = ctx.dist((int)v);
+            byLandmark.push_back(d == QueryContext::kInf ? kUnreachable : (float)d);
+        }
+    }
+
+    // "Avoid": grow a shortest-path tree from `root`, weigh each node by how
+    // badly the current landmarks bound d(root, v), and descend into the
+    // heaviest subtree that holds no landmark yet; its leaf is the pick.
+    NodeId avoidPick(const CsrGraph& g, NodeId root, QueryContext& ctx) const {
+        const uint32_t n = numNodes, k = (uint32_t)landmarks.size();
+        dijkstra(g, (int)root, -1, ctx);
+        std::vector<NodeId> reached;
+        for (NodeId v=0; v<n; ++v) if (ctx.reached((int)v)) reached.push_back(v);
+        std::sort(reached.begin(), reached.end(), [&](NodeId a, NodeId b){ return ctx.dist((int)a) < ctx.dist((int)b); });
+
+        std::vector<double> size(n, 0.0);
+        std::vector<char> hasLandmark(n, 0);
+        for (NodeId L : landmarks) hasLandmark[L] = 1;
+        auto column = [&](NodeId v, uint32_t i){ return byLandmark[(size_t)i*n + v]; };
+        for (auto it=reached.rbegin(); it!=reached.rend(); ++it){
+            NodeId v = *it;
+            double lb = 0.0;
+            for (uint32_t i=0; i<k; ++i){
+                float a = column(root, i), b = column(v, i);
+                if (a != kUnreachable && b != kUnreachable) lb = std::max(lb, (double)std::fabs(a - b));
+            }
+            size[v] += ctx.dist((int)v) - lb;
+            int p = ctx.parent((int)v);
+            if (p < 0) continue;
+            if (hasLandmark[v]) hasLandmark[p] = 1;
+            if (!hasLandmark[v]) size[p] += size[v];
+        }
+
+        // Descend into the heaviest landmark-free child until reaching a leaf.
+        NodeId cur = root;
+        for (;;){
+            NodeId next = CsrGraph::kInvalid; double bestSize = 0.0;
+            for (auto a=g.arcBegin(cur); a<g.arcEnd(cur); ++a){
+                NodeId c = g.arcTarget(a);
+                if (ctx.parent((int)c) == (int)cur && !hasLandmark[c] && size[c] > bestSize){ bestSize = size[c]; next = c; }
+            }
+            if (next == CsrGraph::kInvalid){
+                bool taken = std::find(landmarks.begin(), landmarks.end(), cur) != landmarks.end();
+                return taken ? CsrGraph::kInvalid : cur;
+            }
+            cur = next;
+        }
+    }
+
+    // byLandmark (one column per landmark, as built) -> node-major table.
+    void transpose(){
+        const uint32_t k = (uint32_t)landmarks.size();
+        std::vector<float> rows((size_t)numNodes*k, kUnreachable);
+        for (uint32_t i=0; i<k; ++i)
+            for (NodeId v=0; v<numNodes; ++v) rows[(size_t)v*k + i] = byLandmark[(size_t)i*numNodes + v];
+        table = std::move(rows);
+        byLandmark.clear(); byLandmark.shrink_to_fit();
+    }
+
+    friend class GraphFile;
+
+    uint32_t numNodes = 0;
+    std::vector<uint32_t> landmarks;
+    Column<float>         table;      // numNodes x k
+    std::vector<float>    byLandmark; // build-time scratch, k x numNodes
+};
+
+// A* potential from the landmark table; the target's row is looked up once.
+class AltPotential {
+public:
+    AltPotential(const LandmarkTable& t, int target)
+        : table(&t), targetRow(t.row((uint32_t)target)), k(t.numLandmarks()) {}
+
+    double operator()(int v) const { return LandmarkTable::bound(table->row((uint32_t)v), targetRow, k); }
+
+private:
+    const LandmarkTable* table;
+    const float* targetRow;
+    uint32_t k;
+};
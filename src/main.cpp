@@ -2,8 +2,6 @@
 #include <vector>
 #include <string>
 #include <cmath>
-#include <queue>
-#include <map>
 #include <limits>
 #include <algorithm>
 #include <unordered_map>
@@ -12,10 +10,40 @@
 #include <cctype>
 #include <sstream>
 #include <iomanip>
+#include <chrono>
+#include <random>
+#include <future>
+#include <atomic>
 
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 
+#include "graph.h"
+#include "dijkstra.h"
+#include "astar.h"
+#include "bidirectional.h"
+#include "contraction_hierarchy.h"
+#include "metrics.h"
+#include "customizable_ch.h"
+#include "landmarks.h"
+#include "hub_labels.h"
+#include "distance_matrix.h"
+#include "many_to_many.h"
+#include "route_cache.h"
+#include "dynamic_spt.h"
+#include "pareto.h"
+#include "k_shortest.h"
+#include "time_dependent.h"
+#include "delta_stepping.h"
+#include "thread_pool.h"
+#include "isochrone.h"
+#include "csv_loader.h"
+#include "graph_file.h"
+#include "paged_graph.h"
+#include "node_order.h"
+#include "chain_graph.h"
+#include "integer_dijkstra.h"
+
 #ifdef _WIN32
   #define WIN32_LEAN_AND_MEAN
   #include <windows.h>
@@ -55,30 +83,10 @@ void main(){
 }
 )";
 
-// ---------------- Data types (classes) ----------------
-class Node {
-public:
-    float x{}, y{};
-    std::string name;
-
-    Node() = default;
-    Node(float x_, float y_, std::string name_) : x(x_), y(y_), name(std::move(name_)) {}
-};
-
-class WeightedLine {
-public:
-    int start{}, end{};
-    double weight{};
-
-    WeightedLine() = default;
-    WeightedLine(int s, int e, double w) : start(s), end(e), weight(w) {}
-};
-
 // ---------------- Graph / render state ----------------
 std::vector<Node> nodes;
-std::vector<int> lines; // pairs of indices
-std::vector<WeightedLine> linesWithWeights;
-std::vector<std::vector<std::pair<int,double>>> adjacencyList;
+CsrGraph graph; // single copy of the topology, used for routing and drawing
+std::vector<CsrGraph::NodeId> externalIds; // id of each node in kNodesFile (or the built-in list)
 
 int selectedNodeIndex1 = -1;
 int selectedNodeIndex2 = -1;
@@ -86,6 +94,141 @@ int lastClickedNodeIndex = -1;
 
 std::vector<int> pathIndices;
 double totalPathDistance = 0.0;
+double totalPathTime = 0.0;   // hours, from per-edge speeds and travel-time profiles
+double totalPathCost = 0.0;   // fare plus tolls along the route
+
+// Routing
+enum class RouteMode { Dijkstra, AStar, Bidirectional, BidirectionalAStar, ContractionHierarchy,
+                       CustomizableCH, ALT, HubLabels, Matrix, IntegerDijkstra, Count };
+RouteMode routeMode = RouteMode::AStar;   // M cycles through modes; Matrix once one is built
+double euclideanScale = 0.0;              // A* heuristic factor, calibrated with the metric weights
+thread_local QueryStats lastQueryStats;   // counters of this thread's most recent findShortestPath
+ContractionHierarchy hierarchy;           // built in preprocessGraph
+LandmarkTable landmarkTable;              // ALT distances, cached in kLandmarkFile
+static const uint32_t kLandmarkCount = 16;
+static const char*    kLandmarkFile  = "landmarks.bin";
+static const char*    kNodesFile     = "data/nodes.csv";   // the network; built-in cities if missing
+static const char*    kEdgesFile     = "data/edges.csv";
+static const char*    kGraphFile     = "data/graph.pfg";   // mapped copy of the CSV network + CH + landmarks
+uint64_t graphFileVersion = 0;            // graph.version() as mapped from kGraphFile; its CH and landmarks hold while equal
+uint64_t graphFileFingerprint = 0;
+
+// Nodes are renumbered into kNodeOrder at load so searches touch nearby
+// memory; N times the same routes in every order (kOrderBenchQueries each).
+static const NodeOrder::Strategy kNodeOrder = NodeOrder::Strategy::Hilbert;
+static const size_t kOrderBenchQueries = 50;
+
+// V builds kCheckGraphs random graphs (up to kCheckMaxNodes nodes, a third of
+// the roads weighing 0 between nodes at one spot, as in OSM imports) and
+// checks every exact mode on every pair against Dijkstra, and delta-stepping
+// from one source per graph under each of kCheckDeltas (0 = suggestDelta).
+// Every kCheckLargeEvery-th graph has more nodes than one distance-matrix
+// tile, up to kCheckLargeNodes, so the blocked phases run too; those are
+// checked from kCheckLargeSources sources to every node.
+static const int kCheckGraphs   = 300;
+static const int kCheckMaxNodes = 40;
+static const int kCheckLargeEvery   = 10;
+static const int kCheckLargeNodes   = 150;
+static const int kCheckLargeSources = 8;
+static const double kCheckDeltas[] = {1e-9, 1e-3, 0.0, 1.0, 1e3, 1e9};
+
+// Out-of-core routing (D): Dijkstra, A*, ALT and the bidirectional searches
+// read arcs from kPagedFile through a page cache of kPageCacheBytes instead
+// of from `graph`. The file is reused while it matches the graph and
+// weight updates patch only their pages. `--paged FROM TO` on the command
+// line routes from the file alone, without loading the network.
+PagedGraph pagedGraph;
+bool pagedRouting = false;
+uint64_t pagedGraphVersion = 0;           // graph.version() the paged file was written from
+static const char*    kPagedFile      = "data/graph.pages";
+static const uint32_t kPageBytes      = 16u << 10;
+static const size_t   kPageCacheBytes = 32u << 20;
+
+// Chain routing (C): the same searches run on chainGraph, where every run of
+// degree-2 nodes is one arc, and routes are expanded back to every node. It
+// is rebuilt whenever the weights change and takes precedence over D.
+ChainGraph chainGraph;
+bool chainRouting = false;
+uint64_t chainGraphVersion = 0;           // graph.version() the chains were built from
+HubLabels hubLabels;                      // distance oracle over the CH order; built on first use
+DistanceMatrix distanceMatrix;            // all pairs, only for graphs up to kMatrixMaxNodes
+static const uint32_t kMatrixMaxNodes = 2048;
+static const char*    kMatrixFile     = "distances.bin";
+RouteCache routeCache(8u << 20);          // finished routes, 8 MB budget; keyed on graph.version()
+
+// Metrics: only Dijkstra (the oracle) and the CCH are metric-aware, every
+// other mode is preprocessed for distance and hands other metrics to the CCH.
+// Time is the exception once edges carry profiles: then every mode runs
+// time-dependent A* (Dijkstra: without potential) from departureHour.
+Metric routeMetric = Metric::Distance;    // W cycles through metrics
+MetricModel metricModel{kSpeedUnitsPerHour, kCostPerUnit};
+std::vector<double> metricWeights[(int)Metric::Count];   // per-edge value of each metric
+CustomizableCH customizableHierarchy;
+CustomizableCH::Customization metricCustomizations[(int)Metric::Count];
+
+// Integer Dijkstra: every metric quantized to fixed point (metres, seconds,
+// 1/100 BDT). Graphs whose largest arc fits kDialMaxWeight units use Dial's
+// buckets, others the radix heap. Q compares both against the
+// double/binary-heap search on kQueueBenchQueries routes.
+QuantizedGraph quantizedGraphs[(int)Metric::Count];     // empty if the metric does not fit 32 bits
+
+// Hub labels, the CCH (with its customizations), the integer graphs and the
+// per-edge metric weights with the A* scales are built by prepareRouting()
+// on the main thread the first time a route needs them, so a mapped start
+// neither pays for modes it never uses nor reads every edge before the first
+// click. Searches on the workers only read them once the flag is set, and
+// fall back otherwise.
+std::atomic<bool> metricsReady{false};
+std::atomic<bool> hubLabelsReady{false};
+std::atomic<bool> customizableReady{false};
+std::atomic<bool> quantizedReady{false};
+static const double   kQuantizedUnits[(int)Metric::Count] = {1000.0, 3600.0, 100.0};
+static const uint32_t kDialMaxWeight     = 1u << 16;
+static const size_t   kQueueBenchQueries = 100;
+TravelTimeProfiles travelProfiles;        // time-of-day factors on some edges
+double departureHour = 8.0;               // , / . move it by an hour
+std::vector<double> minEdgeTimes;         // per-edge lower bound over the day
+double timeEuclideanScale = 0.0;          // A* scale for time, from minEdgeTimes
+
+// Weight updates: the CCH re-customizes and the displayed route's distance
+// tree is repaired in place; CH, hub labels, landmarks and the matrix are
+// flagged stale (their modes fall back to the CCH) until R rebuilds them.
+ShortestPathTree routeTree;               // rooted at the displayed route's start
+bool preprocessingStale = false;
+static const double kCongestionFactor = 1.25; // '=' / '-' scale the displayed route by this
+
+// Alternative routes, drawn under the main route in the colours below:
+// the Pareto set over distance, time and cost (P) or the k shortest loopless
+// routes by distance (K), best ranks on top.
+enum class Alternatives { None, Pareto, KShortest };
+Alternatives alternativesMode = Alternatives::None;
+std::vector<std::vector<int>> alternativeRoutes;
+ParetoRouter paretoRouter;
+static const double   kParetoEpsilon     = 0.01; // drop labels within 1% of a kept one on every criterion
+static const uint32_t kShortestPathCount = 5;    // routes K shows, the highlighted one included
+static const float  kAlternativeColors[][3] = {
+    {0.25f,0.60f,1.00f}, {1.00f,0.35f,0.35f}, {1.00f,0.85f,0.20f},
+    {0.80f,0.45f,1.00f}, {0.30f,1.00f,0.90f}, {1.00f,0.60f,0.20f}
+};
+
+// Batch (B): random route queries answered on the shared pool while the
+// window keeps drawing. Keys that change weights or departure wait for it.
+static const size_t kBatchQueries = 200000;
+std::future<std::vector<double>> batchResult;
+std::atomic<uint64_t> batchSettled{0};
+std::chrono::steady_clock::time_point batchStarted;
+PagedGraph::Stats batchPages;             // pagedGraph.totals() when the batch started
+RouteMode batchMode = RouteMode::Dijkstra;
+
+// Isochrone (I): what the last clicked city reaches within a budget of one
+// metric; Up/Down or the mouse wheel move the budget.
+bool isochroneOn = false;
+Metric isochroneMetric = Metric::Time;                      // I cycles time, cost, distance, off
+double isochroneBudget[(int)Metric::Count] = {300.0, 4.0, 1000.0}; // KM, hours, BDT
+Isochrone isochrone;
+std::vector<float> isochroneLines, isochroneArea; // GL vertices, rebuilt when the budget moves
+double isochroneShown = -1.0;                     // budget the vertices were built for
+static const double kIsochroneStep = 1.25;        // Up/Down factor; one wheel notch is a fifth of it
 
 // GL
 unsigned int shaderProgram;
@@ -171,13 +314,56 @@ static const std::unordered_map<char, std::array<uint8_t,7>> GLYPH_5x7 = {
 // ---------------- Decls ----------------
 void framebuffer_size_callback(GLFWwindow*, int, int);
 void mouse_button_callback(GLFWwindow*, int, int, int);
+void scroll_callback(GLFWwindow*, double, double);
 void processInput(GLFWwindow*);
 
 void setupNodesAndLines();
+bool fileIsCurrent(const char* path);
+bool loadGraphFile();
+void saveGraphFile();
+void renumberNodes();
+int externalId(int node);
+void benchmarkNodeOrders();
+void checkExactModes();
 unsigned int compileProgram(const char* vs, const char* fs);
 void setupMapBuffers();
-void drawHighlightedPath();
+void drawHighlightedPath(const std::vector<int>& path, float r, float g, float b);
 std::pair<std::vector<int>, double> findShortestPath(int start, int end);
+std::pair<std::vector<int>, double> findShortestPath(int start, int end, RouteMode mode, Metric metric);
+template<class Graph>
+std::pair<std::vector<int>, double> searchGraph(const Graph& g, int start, int end, RouteMode mode, Metric metric);
+bool openPagedGraph();
+bool patchPagedGraph(const std::vector<CsrGraph::EdgeId>& changed);
+bool routeOnPagedFile(const std::string& from, const std::string& to);
+void togglePagedRouting();
+void buildChainGraph();
+template<class Queue>
+std::pair<std::vector<int>, double> integerRoute(const QuantizedGraph& q, int start, int end, Metric metric);
+void benchmarkQueues();
+void toggleChainRouting();
+const char* routeModeName(RouteMode mode);
+void customizeMetrics();
+void buildMetrics();
+void measurePath(const std::vector<int>& path, Metric metric, double& distance, double& hours, double& cost);
+void setupTravelProfiles();
+void shiftDeparture(double hours);
+void printDistanceTable();
+void printReachability(int source);
+void preprocessGraph();
+void prepareRouting(RouteMode mode, Metric metric);
+void buildHubLabels();
+void buildCustomizableCH();
+void quantizeMetrics();
+void updateEdgeWeights(const std::vector<std::pair<CsrGraph::EdgeId, double>>& updates);
+void scaleDisplayedRoute(double factor);
+void computeAlternatives(int start, int end);
+void toggleAlternatives(Alternatives mode);
+void startBatch();
+bool batchRunning();
+void cycleIsochrone();
+void scaleIsochroneBudget(double factor);
+void refreshIsochrone();
+void drawIsochrone();
 
 // Path info labels (distance/time/cost) — now HUD bottom-left
 void drawPathInfoLabels();
@@ -192,7 +378,9 @@ void openAllImagesForNode(int nodeIndex);
 int  wrapIndex(int i, int n);
 
 // ---------------- Main ----------------
-int main(){
+int main(int argc, char** argv){
+    if (argc == 4 && std::string(argv[1]) == "--paged") return routeOnPagedFile(argv[2], argv[3]) ? 0 : 1;
+
     if (!glfwInit()){ std::cout<<"Failed to init GLFW\n"; return -1; }
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR,3);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR,3);
@@ -206,6 +394,7 @@ int main(){
     glfwMakeContextCurrent(window);
     glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
     glfwSetMouseButtonCallback(window, mouse_button_callback);
+    glfwSetScrollCallback(window, scroll_callback);
 
     if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)){
         std::cout<<"Failed to init GLAD\n"; return -1;
@@ -227,6 +416,21 @@ int main(){
     std::cout << "Controls:\n";
     std::cout << "  • Left-click two nodes: computes and highlights the shortest path.\n";
     std::cout << "  • Bottom-left HUD shows: distance (small), estimated time (small), travel cost (small).\n";
+    std::cout << "  • M: cycle routing mode (now " << routeModeName(routeMode) << ").\n";
+    std::cout << "  • W: cycle the metric routes are optimal for (now " << metricName(routeMetric) << ").\n";
+    std::cout << "  • T: print the city-to-city distance table; G: everything reachable from the last clicked city.\n";
+    std::cout << "  • = / -: make the highlighted route slower / faster; R: rebuild stale preprocessing.\n";
+    std::cout << "  • P: also show every route that is best on some trade-off of distance, time and cost.\n";
+    std::cout << "  • K: also show the next shortest routes (" << kShortestPathCount << " in all), ranked by colour.\n";
+    std::cout << "  • B: answer " << kBatchQueries << " random routes on all " << sharedPool().size() << " worker thread(s) in the background.\n";
+    std::cout << "  • I: shade what the last clicked city reaches within " << isochroneBudget[(int)Metric::Time]
+              << "H / " << isochroneBudget[(int)Metric::Cost] << " " << kCurrency << " (press again to switch); Up/Down or wheel: budget.\n";
+    std::cout << "  • , / .: depart an hour earlier / later (now " << departureHour << "h); time-optimal routes follow.\n";
+    std::cout << "  • C: route on a graph with every run of degree-2 nodes merged into one edge.\n";
+    std::cout << "  • Q: compare double and integer Dijkstra queues (" << kQueueBenchQueries << " routes each).\n";
+    std::cout << "  • N: compare node orders (" << kOrderBenchQueries << " Dijkstra routes in each).\n";
+    std::cout << "  • V: check every exact routing mode against Dijkstra on " << kCheckGraphs << " random graphs.\n";
+    std::cout << "  • D: route from a paged copy of the graph on disk (" << (kPageCacheBytes >> 20) << " MB page cache); page faults are shown per route.\n";
     std::cout << "  • Image keys (after clicking a node): 1..9, ],[, O,A,L.\n";
     std::cout << "Put your JPEGs in .\\assets and list them in nodeImages at the top of main.cpp.\n\n";
 
@@ -244,11 +448,18 @@ int main(){
         glUniform3f(nodeColor, 1.0f,1.0f,1.0f);
         glUniform1f(alphaLoc, 1.0f);
         glBindVertexArray(VAO_lines);
-        glDrawArrays(GL_LINES, 0, (GLsizei)lines.size());
+        glDrawArrays(GL_LINES, 0, (GLsizei)(graph.numEdges()*2));
 
-        // draw highlighted path
+        refreshIsochrone();
+        drawIsochrone();
+
+        // draw alternatives, then the highlighted path over them
+        for (size_t i=alternativeRoutes.size(); i-- > 0; ){
+            const float* c = kAlternativeColors[i % (sizeof(kAlternativeColors)/sizeof(kAlternativeColors[0]))];
+            drawHighlightedPath(alternativeRoutes[i], c[0], c[1], c[2]);
+        }
         if (!pathIndices.empty()) {
-            drawHighlightedPath();
+            drawHighlightedPath(pathIndices, 0.0f, 1.0f, 0.0f);
         }
 
         // draw nodes
@@ -287,6 +498,10 @@ void framebuffer_size_callback(GLFWwindow*, int w, int h){
     glViewport(0, 0, windowW, windowH);
 }
 
+void scroll_callback(GLFWwindow*, double, double yoffset){
+    scaleIsochroneBudget(std::pow(kIsochroneStep, yoffset / 5.0));
+}
+
 void processInput(GLFWwindow* window){
     if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
         glfwSetWindowShouldClose(window,true);
@@ -303,6 +518,35 @@ void processInput(GLFWwindow* window){
         return fired;
     };
 
+    if (onPress(GLFW_KEY_M)){
+        routeMode = (RouteMode)(((int)routeMode + 1) % (int)RouteMode::Count);
+        std::cout << "Routing mode: " << routeModeName(routeMode) << "\n";
+    }
+    if (onPress(GLFW_KEY_W)){
+        routeMetric = (Metric)(((int)routeMetric + 1) % (int)Metric::Count);
+        std::cout << "Optimising for: " << metricName(routeMetric) << "\n";
+    }
+    if (onPress(GLFW_KEY_T)) printDistanceTable();
+    if (onPress(GLFW_KEY_G) && lastClickedNodeIndex != -1) printReachability(lastClickedNodeIndex);
+    if (onPress(GLFW_KEY_P)) toggleAlternatives(Alternatives::Pareto);
+    if (onPress(GLFW_KEY_K)) toggleAlternatives(Alternatives::KShortest);
+    if (onPress(GLFW_KEY_B)) startBatch();
+    if (onPress(GLFW_KEY_I)) cycleIsochrone();
+    if (onPress(GLFW_KEY_UP))   scaleIsochroneBudget(kIsochroneStep);
+    if (onPress(GLFW_KEY_DOWN)) scaleIsochroneBudget(1.0 / kIsochroneStep);
+    if (!batchRunning()){
+        if (onPress(GLFW_KEY_EQUAL)) scaleDisplayedRoute(kCongestionFactor);
+        if (onPress(GLFW_KEY_MINUS)) scaleDisplayedRoute(1.0 / kCongestionFactor);
+        if (onPress(GLFW_KEY_R) && preprocessingStale) preprocessGraph();
+        if (onPress(GLFW_KEY_COMMA))  shiftDeparture(-1.0);
+        if (onPress(GLFW_KEY_PERIOD)) shiftDeparture(+1.0);
+        if (onPress(GLFW_KEY_D)) togglePagedRouting();
+        if (onPress(GLFW_KEY_C)) toggleChainRouting();
+        if (onPress(GLFW_KEY_N)) benchmarkNodeOrders();
+        if (onPress(GLFW_KEY_Q)) benchmarkQueues();
+        if (onPress(GLFW_KEY_V)) checkExactModes();
+    }
+
     if (lastClickedNodeIndex != -1){
         for (int k=GLFW_KEY_1; k<=GLFW_KEY_9; ++k){
             if (onPress(k)){
@@ -365,21 +609,50 @@ void mouse_button_callback(GLFWwindow* window, int button, int action, int){
     if (selectedNodeIndex1 == -1){
         selectedNodeIndex1 = clicked;
         pathIndices.clear();
-        std::cout<<"Starting from: "<<nodes[selectedNodeIndex1].name<<"\n";
+        alternativeRoutes.clear();
+        std::cout<<"Starting from: "<<nodes[selectedNodeIndex1].name<<" (id "<<externalId(selectedNodeIndex1)<<")\n";
     } else if (clicked != selectedNodeIndex1){
         selectedNodeIndex2 = clicked;
-        std::cout<<"Destination is: "<<nodes[selectedNodeIndex2].name<<"\n";
-
-        auto res = findShortestPath(selectedNodeIndex1, selectedNodeIndex2);
+        std::cout<<"Destination is: "<<nodes[selectedNodeIndex2].name<<" (id "<<externalId(selectedNodeIndex2)<<")\n";
+
+        std::pair<std::vector<int>, double> res;
+        const bool cached = routeCache.lookup(selectedNodeIndex1, selectedNodeIndex2, (uint32_t)routeMetric,
+                                              graph.version(), res.first, res.second);
+        if (!cached){
+            res = findShortestPath(selectedNodeIndex1, selectedNodeIndex2);
+            routeCache.insert(selectedNodeIndex1, selectedNodeIndex2, (uint32_t)routeMetric,
+                              graph.version(), res.first, res.second);
+        }
         pathIndices = res.first;
-        totalPathDistance = res.second;
+        measurePath(pathIndices, routeMetric, totalPathDistance, totalPathTime, totalPathCost);
+        alternativeRoutes.clear();
+        QueryStats modeStats = lastQueryStats;
+        PagedGraph::Stats pageStats = PagedGraph::threadStats();
 
         if (!pathIndices.empty()){
             std::cout<<"Path: ";
             for (size_t i=0;i<pathIndices.size();++i){
                 std::cout<<nodes[pathIndices[i]].name<<(i+1<pathIndices.size()? " -> ":"\n");
             }
-            std::cout<<"Total distance: "<<totalPathDistance<<"\n";
+            std::cout<<"Total distance: "<<totalPathDistance<<"  time: "<<totalPathTime<<"H  cost: "
+                     <<totalPathCost<<" "<<kCurrency<<"  (optimal for "<<metricName(routeMetric)<<")\n";
+            RouteCache::Stats cs = routeCache.stats();
+            if (cached) std::cout<<"Route cache hit";
+            else std::cout<<"Settled nodes ("<<routeModeName(routeMode)<<"): "<<modeStats.settled;
+            if (!cached && pageStats.hits + pageStats.faults > 0)
+                std::cout<<"  pages: "<<pageStats.faults<<" faults, "<<pageStats.hits<<" hits";
+            if (!cached && pageStats.errors > 0)
+                std::cout<<"  ("<<pageStats.errors<<" page reads failed, routed in memory)";
+            if (!cached && routeMode != RouteMode::Dijkstra){
+                // Plain Dijkstra doubles as the correctness oracle for the faster modes
+                auto oracle = findShortestPath(selectedNodeIndex1, selectedNodeIndex2, RouteMode::Dijkstra, routeMetric);
+                std::cout<<"  vs Dijkstra: "<<lastQueryStats.settled;
+                if (std::abs(oracle.second - res.second) > 1e-6)
+                    std::cout<<"\nWARNING: Dijkstra says "<<oracle.second<<", "<<routeModeName(routeMode)<<" disagrees";
+            }
+            std::cout<<"\nRoute cache: "<<cs.hits<<" hits, "<<cs.misses<<" misses, "<<cs.evictions<<" evictions, "
+                     <<routeCache.sizeBytes()<<" bytes\n";
+            computeAlternatives(selectedNodeIndex1, selectedNodeIndex2);
         } else {
             std::cout<<"No path found between "<<nodes[selectedNodeIndex1].name<<" and "<<nodes[selectedNodeIndex2].name<<"\n";
         }
@@ -390,27 +663,285 @@ void mouse_button_callback(GLFWwindow* window, int button, int action, int){
 
 // ---------------- Graph setup & rendering ----------------
 void setupNodesAndLines(){
-    nodes = {
-        Node(-0.7f,  0.6f, "Rangpur"),
-        Node( 0.2f,  0.8f, "Sylhet"),
-        Node(-0.3f, -0.4f, "Khulna"),
-        Node( 0.8f, -0.7f, "Chittagong"),
-        Node( 0.0f,  0.0f, "Dhaka"),
-        Node(-0.9f, -0.2f, "Rajshahi"),
-        Node( 0.6f,  0.1f, "Barishal")
-    };
-    lines = { 0,1, 0,2, 1,3, 2,3, 0,4, 1,4, 2,4, 3,4, 5,0, 5,2, 6,1, 6,3 };
-    linesWithWeights = {
-        WeightedLine(0,1,500.0), WeightedLine(0,2,512.0),  WeightedLine(1,3,363.0),
-        WeightedLine(2,3,442.0), WeightedLine(0,4,294.0),  WeightedLine(1,4,240.0),
-        WeightedLine(2,4,222.0),  WeightedLine(3,4,257.0),  WeightedLine(5,0,217.0),
-        WeightedLine(5,2,255.0), WeightedLine(6,1,402.0),  WeightedLine(6,3,243.0)
+    auto t0 = std::chrono::steady_clock::now();
+    std::string error;
+    bool fromText = false;
+    if (fileIsCurrent(kGraphFile) && loadGraphFile()){
+        auto ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+        std::cout << "Mapped " << graph.numNodes() << " nodes and " << graph.numEdges() << " edges from "
+                  << kGraphFile << " in " << std::fixed << std::setprecision(1) << ms << " ms\n"
+                  << std::defaultfloat << std::setprecision(6);
+    } else if (CsvGraphLoader::load(kNodesFile, kEdgesFile, nodes, graph, error)){
+        fromText = true;
+        auto ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+        std::cout << "Loaded " << graph.numNodes() << " nodes and " << graph.numEdges() << " edges from "
+                  << kNodesFile << " / " << kEdgesFile << " in " << std::fixed << std::setprecision(1) << ms << " ms\n"
+                  << std::defaultfloat << std::setprecision(6);
+    } else {
+        std::cout << error << "; using the built-in cities\n";
+        nodes = {
+            Node(-0.7f,  0.6f, "Rangpur"),
+            Node( 0.2f,  0.8f, "Sylhet"),
+            Node(-0.3f, -0.4f, "Khulna"),
+            Node( 0.8f, -0.7f, "Chittagong"),
+            Node( 0.0f,  0.0f, "Dhaka"),
+            Node(-0.9f, -0.2f, "Rajshahi"),
+            Node( 0.6f,  0.1f, "Barishal")
+        };
+        // Speed (units/h) and toll are given where they differ from the defaults:
+        // Jamuna and Padma bridge tolls, the Dhaka-Chittagong four-lane highway,
+        // congestion on the Sylhet road.
+        std::vector<WeightedLine> edges = {
+            WeightedLine(0,1,500.0), WeightedLine(0,2,512.0),  WeightedLine(1,3,363.0),
+            WeightedLine(2,3,442.0), WeightedLine(0,4,294.0, 45.0, 500.0),  WeightedLine(1,4,240.0, 40.0, 0.0),
+            WeightedLine(2,4,222.0, 55.0, 750.0),  WeightedLine(3,4,257.0, 60.0, 100.0),  WeightedLine(5,0,217.0),
+            WeightedLine(5,2,255.0), WeightedLine(6,1,402.0),  WeightedLine(6,3,243.0)
+        };
+        graph = CsrGraph::build(nodes.size(), edges);
+    }
+    if (graph.version() != graphFileVersion) renumberNodes(); // a mapped file is stored renumbered
+    setupTravelProfiles();
+    preprocessGraph();
+    if (fromText) saveGraphFile();
+    if (!distanceMatrix.empty()) routeMode = RouteMode::Matrix;
+}
+
+// A binary file stands in for the CSV files while it is at least as new.
+bool fileIsCurrent(const char* path){
+    std::error_code ec;
+    const auto written = std::filesystem::last_write_time(path, ec);
+    if (ec) return false;
+    for (const char* text : {kNodesFile, kEdgesFile}){
+        const auto edited = std::filesystem::last_write_time(text, ec);
+        if (!ec && edited > written) return false;
+    }
+    return true;
+}
+
+bool loadGraphFile(){
+    GraphFile::Contents contents;
+    std::string error;
+    if (!GraphFile::load(kGraphFile, contents, error)){
+        std::cout << error << "; reading " << kNodesFile << " / " << kEdgesFile << " instead\n";
+        return false;
+    }
+    nodes = std::move(contents.nodes);
+    externalIds = std::move(contents.externalIds);
+    graph = std::move(contents.graph);
+    hierarchy = std::move(contents.hierarchy);
+    landmarkTable = std::move(contents.landmarks);
+    graphFileVersion = graph.version();
+    graphFileFingerprint = contents.fingerprint;
+    return true;
+}
+
+// Snapshot of the freshly parsed network with its CH and landmarks, so the
+// next start maps it instead of parsing and preprocessing again.
+void saveGraphFile(){
+    auto t0 = std::chrono::steady_clock::now();
+    std::string error;
+    if (!GraphFile::save(kGraphFile, nodes, externalIds, graph, &hierarchy, &landmarkTable, error)){
+        std::cout << error << "\n";
+        return;
+    }
+    auto ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    std::cout << "Wrote " << kGraphFile << " in " << std::fixed << std::setprecision(1) << ms << " ms\n"
+              << std::defaultfloat << std::setprecision(6);
+}
+
+// Renumbers freshly loaded nodes into kNodeOrder; externalIds keeps the ids
+// they had in the source data for the UI.
+void renumberNodes(){
+    auto t0 = std::chrono::steady_clock::now();
+    const double gapBefore = NodeOrder::measure(graph).meanGap;
+    NodeOrder::apply(NodeOrder::compute(kNodeOrder, nodes, graph), nodes, graph, externalIds);
+    auto ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    std::cout << "Nodes renumbered in " << NodeOrder::name(kNodeOrder) << " order in " << std::fixed
+              << std::setprecision(1) << ms << " ms (mean arc gap 2^" << std::setprecision(2) << gapBefore
+              << " -> 2^" << NodeOrder::measure(graph).meanGap << ")\n" << std::defaultfloat << std::setprecision(6);
+}
+
+int externalId(int node){
+    return externalIds.empty() ? node : (int)externalIds[node];
+}
+
+// Dhaka-bound roads jam in the morning and evening peaks; the Barishal
+// crossings run a thin ferry service at night. Falls are kept gentle enough
+// for the longest edges to stay FIFO. Only the two cities' own roads are
+// visited, so a mapped start does not read every edge here.
+void setupTravelProfiles(){
+    const uint32_t rushHours   = travelProfiles.addBreakpoints({0.0f, 6.0f, 8.0f, 13.0f, 16.0f, 18.0f, 23.0f});
+    const uint32_t dhakaTraffic = travelProfiles.addProfile(rushHours, {1.0, 1.0, 1.6, 1.0, 1.0, 1.7, 1.0});
+    const uint32_t ferryHours  = travelProfiles.addBreakpoints({0.0f, 4.0f, 10.0f, 20.0f, 22.0f});
+    const uint32_t nightFerry  = travelProfiles.addProfile(ferryHours, {1.6, 1.6, 1.0, 1.0, 1.6});
+    int dhaka = -1, barishal = -1;
+    for (int v=0; v<(int)nodes.size(); ++v){
+        if (nodes[v].name == "Dhaka") dhaka = v;
+        if (nodes[v].name == "Barishal") barishal = v;
+    }
+    auto assignAround = [&](int v, uint32_t profile, int skip){
+        if (v < 0) return;
+        for (CsrGraph::ArcId arc=graph.arcBegin(v); arc<graph.arcEnd(v); ++arc){
+            if ((int)graph.arcTarget(arc) == skip) continue; // Dhaka's profile wins on a shared road
+            const CsrGraph::EdgeId e = graph.arcEdge(arc);
+            const int a = (int)graph.edgeTail(e), b = (int)graph.edgeHead(e);
+            if (!travelProfiles.assign(e, profile, metricModel.edgeTime(graph, e)))
+                std::cout << "Profile would break FIFO on " << nodes[a].name << "-" << nodes[b].name << ", kept static\n";
+        }
     };
-    adjacencyList.resize(nodes.size());
-    for (const auto& e: linesWithWeights){
-        adjacencyList[e.start].push_back({e.end, e.weight});
-        adjacencyList[e.end].push_back({e.start, e.weight});
+    assignAround(dhaka, dhakaTraffic, -1);
+    assignAround(barishal, nightFerry, dhaka);
+    std::cout << "Travel-time profiles: " << travelProfiles.sizeBytes() << " bytes\n";
+}
+
+// Moves the departure time and re-routes the highlighted route if it is
+// optimised for time (other metrics do not depend on the clock).
+void shiftDeparture(double hours){
+    departureHour = std::fmod(departureHour + hours + TravelTimeProfiles::kDayHours, TravelTimeProfiles::kDayHours);
+    routeCache.clear();
+    std::cout << "Departure: " << std::setw(2) << std::setfill('0') << (int)departureHour << ":00\n" << std::setfill(' ');
+    if (pathIndices.size() < 2) return;
+    if (routeMetric == Metric::Time) pathIndices = findShortestPath(pathIndices.front(), pathIndices.back()).first;
+    measurePath(pathIndices, routeMetric, totalPathDistance, totalPathTime, totalPathCost);
+    std::cout << "Route: ";
+    for (size_t i=0;i<pathIndices.size();++i)
+        std::cout << nodes[pathIndices[i]].name << (i+1<pathIndices.size()? " -> ":"\n");
+    std::cout << "Total distance: " << totalPathDistance << "  time: " << totalPathTime << "H  cost: "
+              << totalPathCost << " " << kCurrency << "\n";
+}
+
+// Everything derived from the current weights. Run at load and again (R)
+// after weight updates have made it stale.
+void preprocessGraph(){
+    const bool mapped = graph.version() == graphFileVersion; // CH and landmarks came with the graph
+
+    auto t0 = std::chrono::steady_clock::now();
+    const bool storedHierarchy = mapped && !hierarchy.empty();
+    if (!storedHierarchy) hierarchy = ContractionHierarchy::build(graph);
+    auto ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    std::cout << "Contraction hierarchy: " << hierarchy.shortcutCount() << " shortcuts "
+              << (storedHierarchy ? "mapped" : "built") << " in "
+              << std::fixed << std::setprecision(1) << ms << " ms\n" << std::defaultfloat << std::setprecision(6);
+
+    // Hub labels follow the CH order, so they are rebuilt from it on next use
+    hubLabelsReady = false;
+    hubLabels = HubLabels();
+    customizeMetrics();
+
+    // Landmarks: reuse the table on disk when it was built for this graph
+    t0 = std::chrono::steady_clock::now();
+    const uint64_t fingerprint = mapped ? graphFileFingerprint : graph.fingerprint();
+    bool loaded = (mapped && landmarkTable.numLandmarks() > 0) ||
+                  LandmarkTable::load(kLandmarkFile, fingerprint, graph.numNodes(), landmarkTable);
+    if (!loaded){
+        landmarkTable = LandmarkTable::build(graph, kLandmarkCount, LandmarkTable::Selection::Avoid);
+        if (!landmarkTable.save(kLandmarkFile, fingerprint))
+            std::cout << "Could not write " << kLandmarkFile << "\n";
+    }
+    ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    std::cout << "Landmarks: " << landmarkTable.numLandmarks() << (loaded ? " loaded" : " selected")
+              << " in " << std::fixed << std::setprecision(1) << ms << " ms ("
+              << landmarkTable.sizeBytes() << " bytes)\n" << std::defaultfloat << std::setprecision(6);
+
+    // All-pairs matrix: small enough graphs answer every click by lookup
+    if (graph.numNodes() <= kMatrixMaxNodes){
+        t0 = std::chrono::steady_clock::now();
+        loaded = DistanceMatrix::load(kMatrixFile, fingerprint, graph.numNodes(), distanceMatrix);
+        if (!loaded){
+            distanceMatrix = DistanceMatrix::build(graph);
+            if (!distanceMatrix.save(kMatrixFile, fingerprint))
+                std::cout << "Could not write " << kMatrixFile << "\n";
+        }
+        ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+        std::cout << "Distance matrix: " << graph.numNodes() << "x" << graph.numNodes()
+                  << (loaded ? " loaded" : " built") << " in " << std::fixed << std::setprecision(1) << ms
+                  << " ms (" << distanceMatrix.sizeBytes() << " bytes)\n" << std::defaultfloat << std::setprecision(6);
+    }
+    preprocessingStale = false;
+}
+
+// Re-weights every metric and recalibrates the A* scales, and the CCH and
+// integer graphs if they have been built; call again whenever edge values
+// change. Does nothing until buildMetrics() has run once.
+void customizeMetrics(){
+    if (!metricsReady) return;
+    auto t0 = std::chrono::steady_clock::now();
+    euclideanScale = calibrateEuclideanScale(nodes, graph);
+    for (int m=0; m<(int)Metric::Count; ++m){
+        metricWeights[m] = metricModel.edgeWeights(graph, (Metric)m);
+        if (customizableReady) metricCustomizations[m] = customizableHierarchy.customize(metricWeights[m]);
+    }
+    if (quantizedReady) quantizeMetrics();
+    minEdgeTimes = minTravelTimes(travelProfiles, metricWeights[(int)Metric::Time]);
+    timeEuclideanScale = calibrateEuclideanScale(nodes, graph, minEdgeTimes);
+    auto ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    std::cout << (customizableReady ? "Customized " : "Weighted ") << (int)Metric::Count << " metrics in "
+              << std::fixed << std::setprecision(1) << ms << " ms\n" << std::defaultfloat << std::setprecision(6);
+}
+
+// Per-edge weights of every metric and the A* scales, each a full pass over
+// the edges; plain distance routes read the graph's own arc weights instead.
+void buildMetrics(){
+    if (metricsReady) return;
+    metricsReady = true;
+    customizeMetrics();
+}
+
+// Builds whatever a route in `mode` and `metric` will read and this session
+// has not built yet. Main thread only; batches call it before queueing.
+void prepareRouting(RouteMode mode, Metric metric){
+    const bool guided = mode == RouteMode::AStar || mode == RouteMode::BidirectionalAStar;
+    if (metric != Metric::Distance || guided) buildMetrics();
+    if (metric == Metric::Time && !travelProfiles.empty()) return; // time-dependent A* in every mode
+    if (mode == RouteMode::HubLabels && !preprocessingStale) buildHubLabels();
+    if (mode == RouteMode::IntegerDijkstra && !quantizedReady) quantizeMetrics();
+    const bool preprocessed = mode == RouteMode::ContractionHierarchy || mode == RouteMode::HubLabels ||
+                              mode == RouteMode::ALT || mode == RouteMode::Matrix;
+    if (mode == RouteMode::CustomizableCH || (preprocessed && preprocessingStale) ||
+        (metric != Metric::Distance && mode != RouteMode::Dijkstra && mode != RouteMode::IntegerDijkstra))
+        buildCustomizableCH();
+}
+
+// Hub labels, most important (highest CH rank) node first
+void buildHubLabels(){
+    if (hubLabelsReady) return;
+    auto t0 = std::chrono::steady_clock::now();
+    std::vector<CsrGraph::NodeId> importance(graph.numNodes());
+    for (CsrGraph::NodeId v=0; v<graph.numNodes(); ++v) importance[graph.numNodes()-1-hierarchy.rank(v)] = v;
+    hubLabels = HubLabels::build(graph, importance);
+    hubLabelsReady = true;
+    auto ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    std::cout << "Hub labels: " << hubLabels.numEntries() << " entries ("
+              << std::fixed << std::setprecision(1) << (double)hubLabels.numEntries()/std::max(1u, graph.numNodes())
+              << " per node, " << hubLabels.sizeBytes() << " bytes) in " << ms << " ms\n" << std::defaultfloat << std::setprecision(6);
+}
+
+// The nested-dissection order only depends on the topology and coordinates,
+// so it is built once; customizeMetrics() keeps the weights current.
+void buildCustomizableCH(){
+    if (customizableReady) return;
+    buildMetrics();
+    auto t0 = std::chrono::steady_clock::now();
+    customizableHierarchy = CustomizableCH::build(graph, nodes);
+    for (int m=0; m<(int)Metric::Count; ++m) metricCustomizations[m] = customizableHierarchy.customize(metricWeights[m]);
+    customizableReady = true;
+    auto ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    std::cout << "Customizable CH: " << customizableHierarchy.numArcs() << " arcs, "
+              << customizableHierarchy.numTriangles() << " triangles, ordered and customized in "
+              << std::fixed << std::setprecision(1) << ms << " ms\n" << std::defaultfloat << std::setprecision(6);
+}
+
+// (Re)quantizes every metric from metricWeights.
+void quantizeMetrics(){
+    buildMetrics();
+    for (int m=0; m<(int)Metric::Count; ++m){
+        std::string error;
+        if (!QuantizedGraph::build(graph, metricWeights[m], kQuantizedUnits[m], quantizedGraphs[m], error)){
+            std::cout << "Integer " << metricName((Metric)m) << ": " << error << "; Dijkstra (integer) uses doubles\n";
+            quantizedGraphs[m] = QuantizedGraph();
+        }
     }
+    quantizedReady = true;
 }
 
 unsigned int compileProgram(const char* vs, const char* fs){
@@ -447,9 +978,10 @@ void setupMapBuffers(){
     glEnableVertexAttribArray(0);
 
     // lines
-    std::vector<float> segs; segs.reserve(lines.size()*3);
-    for (int idx : lines){
-        segs.insert(segs.end(), {nodes[idx].x, nodes[idx].y, 0.0f});
+    std::vector<float> segs; segs.reserve(graph.numEdges()*6);
+    for (CsrGraph::EdgeId e=0; e<graph.numEdges(); ++e){
+        const auto &a = nodes[graph.edgeTail(e)], &b = nodes[graph.edgeHead(e)];
+        segs.insert(segs.end(), {a.x, a.y, 0.0f, b.x, b.y, 0.0f});
     }
     glGenVertexArrays(1,&VAO_lines);
     glGenBuffers(1,&VBO_lines);
@@ -463,14 +995,14 @@ void setupMapBuffers(){
     glBindVertexArray(0);
 }
 
-void drawHighlightedPath(){
-    if (pathIndices.size()<2) return;
+void drawHighlightedPath(const std::vector<int>& path, float r, float g, float b){
+    if (path.size()<2) return;
     std::vector<float> verts;
-    verts.reserve((pathIndices.size()-1)*6);
-    for (size_t i=0;i+1<pathIndices.size();++i){
-        auto &a = nodes[pathIndices[i]];
-        auto &b = nodes[pathIndices[i+1]];
-        verts.insert(verts.end(), {a.x,a.y,0.0f, b.x,b.y,0.0f});
+    verts.reserve((path.size()-1)*6);
+    for (size_t i=0;i+1<path.size();++i){
+        auto &from = nodes[path[i]];
+        auto &to   = nodes[path[i+1]];
+        verts.insert(verts.end(), {from.x,from.y,0.0f, to.x,to.y,0.0f});
     }
     GLuint vao,vbo;
     glGenVertexArrays(1,&vao);
@@ -483,7 +1015,7 @@ void drawHighlightedPath(){
 
     int nodeColor = glGetUniformLocation(shaderProgram,"nodeColor");
     int alphaLoc  = glGetUniformLocation(shaderProgram,"uAlpha");
-    glUniform3f(nodeColor, 0.0f,1.0f,0.0f);
+    glUniform3f(nodeColor, r,g,b);
     glUniform1f(alphaLoc, 1.0f);
     glDrawArrays(GL_LINES, 0, (GLsizei)(verts.size()/3));
 
@@ -491,34 +1023,874 @@ void drawHighlightedPath(){
     glDeleteVertexArrays(1,&vao);
 }
 
-// Dijkstra
+// Shortest path in the current routing mode and metric
 std::pair<std::vector<int>, double> findShortestPath(int start, int end){
+    prepareRouting(routeMode, routeMetric);
+    return findShortestPath(start, end, routeMode, routeMetric);
+}
+
+// Dijkstra / A* (dense arrays + lazy-deletion heap, reused across clicks).
+// The returned value is the route's total in `metric`.
+std::pair<std::vector<int>, double> findShortestPath(int start, int end, RouteMode mode, Metric metric){
+    lastQueryStats = QueryStats{};
+    PagedGraph::threadStats() = PagedGraph::Stats{};
     if (start==end) return {{start}, 0.0};
-    std::map<int,double> dist;
-    std::map<int,int> parent;
-    for (size_t i=0;i<nodes.size();++i){ dist[(int)i]=std::numeric_limits<double>::infinity(); parent[(int)i]=-1; }
-    dist[start]=0.0;
-
-    auto cmp=[&](int a,int b){ return dist[a]>dist[b]; };
-    std::priority_queue<int,std::vector<int>,decltype(cmp)> pq(cmp);
-    pq.push(start);
-
-    while(!pq.empty()){
-        int u=pq.top(); pq.pop();
-        if (u==end) break;
-        for (auto& e: adjacencyList[u]){
-            int v=e.first; double w=e.second;
-            if (dist[u]+w<dist[v]){
-                dist[v]=dist[u]+w; parent[v]=u; pq.push(v);
+
+    if (metric == Metric::Time && !travelProfiles.empty()){
+        QueryContext& ctx = threadQueryContext();
+        const auto& freeFlow = metricWeights[(int)Metric::Time];
+        double d = mode == RouteMode::Dijkstra
+            ? timeDependentAstar(graph, travelProfiles, freeFlow, start, end, departureHour, ctx, ZeroPotential{})
+            : timeDependentAstar(graph, travelProfiles, freeFlow, start, end, departureHour, ctx,
+                                 EuclideanPotential(nodes, timeEuclideanScale, end));
+        lastQueryStats = ctx.stats;
+        if (d==QueryContext::kInf) return {{},0.0};
+        return {ctx.pathTo(end), d};
+    }
+
+    if (metric != Metric::Distance && mode != RouteMode::Dijkstra && mode != RouteMode::IntegerDijkstra)
+        mode = RouteMode::CustomizableCH;
+    if (mode == RouteMode::IntegerDijkstra){
+        const QuantizedGraph& q = quantizedGraphs[(int)metric];
+        if (quantizedReady && !q.empty()){
+            return q.maxArcWeight() <= kDialMaxWeight ? integerRoute<DialQueue>(q, start, end, metric)
+                                                      : integerRoute<RadixHeap>(q, start, end, metric);
+        }
+        mode = RouteMode::Dijkstra;
+    }
+    if (preprocessingStale && (mode == RouteMode::ContractionHierarchy || mode == RouteMode::HubLabels ||
+                               mode == RouteMode::ALT || mode == RouteMode::Matrix))
+        mode = RouteMode::CustomizableCH;
+    if (mode == RouteMode::Matrix && distanceMatrix.empty()) mode = RouteMode::ContractionHierarchy;
+    if (mode == RouteMode::HubLabels && !hubLabelsReady) mode = RouteMode::ContractionHierarchy;
+    if (mode == RouteMode::CustomizableCH && !customizableReady) mode = RouteMode::Dijkstra; // not prepared
+
+    if (mode == RouteMode::Matrix){
+        // "settled" here counts next-hop lookups
+        double d = distanceMatrix.distance(start, end);
+        if (d == DistanceMatrix::kInf) return {{},0.0};
+        std::vector<int> path = distanceMatrix.path(start, end);
+        lastQueryStats.settled = (uint32_t)path.size();
+        if (!path.empty()) return {path, d};
+        mode = RouteMode::Dijkstra; // next hops did not reach `end`
+    }
+
+    if (mode == RouteMode::CustomizableCH){
+        const auto& weights = metricCustomizations[(int)metric];
+        BidirectionalContext& bctx = threadBidirectionalContext();
+        BidirectionalResult r = customizableHierarchy.query(start, end, weights, bctx);
+        lastQueryStats.settled = bctx.forward.stats.settled + bctx.backward.stats.settled;
+        lastQueryStats.relaxed = bctx.forward.stats.relaxed + bctx.backward.stats.relaxed;
+        if (r.meet < 0 || r.distance==QueryContext::kInf) return {{},0.0};
+        return {customizableHierarchy.unpackPath(bctx, r.meet, weights), r.distance};
+    }
+
+    if (mode == RouteMode::ContractionHierarchy){
+        BidirectionalContext& bctx = threadBidirectionalContext();
+        BidirectionalResult r = hierarchy.query(start, end, bctx);
+        lastQueryStats.settled = bctx.forward.stats.settled + bctx.backward.stats.settled;
+        lastQueryStats.relaxed = bctx.forward.stats.relaxed + bctx.backward.stats.relaxed;
+        if (r.meet < 0) return {{},0.0};
+        return {hierarchy.unpackPath(bctx, r.meet), r.distance};
+    }
+
+    if (mode == RouteMode::HubLabels){
+        // "settled" here counts label entries merged
+        lastQueryStats.settled = hubLabels.labelSize(start) + hubLabels.labelSize(end);
+        double d = hubLabels.distance(start, end);
+        if (d == HubLabels::kInf) return {{},0.0};
+        return {hubLabels.path(graph, start, end), d};
+    }
+
+    if (chainRouting && chainGraphVersion == graph.version() && metric == Metric::Distance){
+        const ChainGraph::View view = chainGraph.view(start, end);
+        auto r = searchGraph(view, start, end, mode, metric);
+        r.first = view.expand(r.first);
+        return r;
+    }
+    if (pagedRouting && pagedGraphVersion == graph.version() && metric == Metric::Distance){
+        // A page that could not be read hides its nodes' arcs, so that
+        // search proves nothing; answer from memory instead.
+        const uint64_t errors = PagedGraph::threadStats().errors;
+        auto r = searchGraph(pagedGraph, start, end, mode, metric);
+        if (PagedGraph::threadStats().errors == errors) return r;
+    }
+    return searchGraph(graph, start, end, mode, metric);
+}
+
+// The route is chosen on integer weights; its length is summed in doubles
+// so it compares exactly with the other modes.
+template<class Queue>
+std::pair<std::vector<int>, double> integerRoute(const QuantizedGraph& q, int start, int end, Metric metric){
+    IntegerQueryContext<Queue>& ctx = threadIntegerQueryContext<Queue>();
+    const uint32_t units = integerDijkstra(q, start, end, ctx);
+    lastQueryStats = ctx.stats;
+    if (units == QuantizedGraph::kInf) return {{},0.0};
+    std::vector<int> path = ctx.pathTo(end);
+    const MetricView weights(graph, metricWeights[(int)metric]);
+    double d = 0.0;
+    for (size_t i=1; i<path.size(); ++i){
+        double best = QueryContext::kInf;
+        weights.forEachArc(path[i-1], [&](uint32_t v, double w){ if ((int)v == path[i]) best = std::min(best, w); });
+        d += best;
+    }
+    return {path, d};
+}
+
+// The modes that only walk adjacency lists, on the in-memory graph, the
+// paged copy or a chain view (same node ids, same forEachArc).
+template<class Graph>
+std::pair<std::vector<int>, double> searchGraph(const Graph& g, int start, int end, RouteMode mode, Metric metric){
+    if (mode == RouteMode::Bidirectional || mode == RouteMode::BidirectionalAStar){
+        BidirectionalContext& bctx = threadBidirectionalContext();
+        BidirectionalResult r;
+        if (mode == RouteMode::BidirectionalAStar){
+            EuclideanPotential toEnd(nodes, euclideanScale, end), toStart(nodes, euclideanScale, start);
+            r = bidirectionalSearch(g, g, start, end, bctx,
+                                    AveragedPotential<EuclideanPotential>(toEnd, toStart, false),
+                                    AveragedPotential<EuclideanPotential>(toEnd, toStart, true));
+        } else {
+            r = bidirectionalSearch(g, g, start, end, bctx, ZeroPotential{}, ZeroPotential{});
+        }
+        lastQueryStats.settled = bctx.forward.stats.settled + bctx.backward.stats.settled;
+        lastQueryStats.relaxed = bctx.forward.stats.relaxed + bctx.backward.stats.relaxed;
+        if (r.meet < 0) return {{},0.0};
+        return {bidirectionalPath(bctx, r.meet), r.distance};
+    }
+
+    QueryContext& ctx = threadQueryContext();
+    double d = QueryContext::kInf;
+    switch (mode){
+        case RouteMode::AStar:
+            d = astar(g, start, end, ctx, EuclideanPotential(nodes, euclideanScale, end));
+            break;
+        case RouteMode::ALT:
+            d = astar(g, start, end, ctx, AltPotential(landmarkTable, end));
+            break;
+        default:
+            if (metric == Metric::Distance) d = dijkstra(g, start, end, ctx);
+            else d = dijkstra(MetricView(graph, metricWeights[(int)metric]), start, end, ctx);
+            break;
+    }
+    lastQueryStats = ctx.stats;
+    if (d==QueryContext::kInf) return {{},0.0};
+    return {ctx.pathTo(end), d};
+}
+
+const char* routeModeName(RouteMode mode){
+    switch (mode){
+        case RouteMode::Dijkstra: return "Dijkstra";
+        case RouteMode::AStar:    return "A*";
+        case RouteMode::Bidirectional:      return "Bidirectional Dijkstra";
+        case RouteMode::BidirectionalAStar: return "Bidirectional A*";
+        case RouteMode::ContractionHierarchy: return "Contraction Hierarchy";
+        case RouteMode::CustomizableCH:       return "Customizable CH";
+        case RouteMode::ALT:                  return "ALT (landmarks)";
+        case RouteMode::HubLabels:            return "Hub labels";
+        case RouteMode::Matrix:               return "Distance matrix";
+        case RouteMode::IntegerDijkstra:      return "Dijkstra (integer)";
+        default:                  return "?";
+    }
+}
+
+// Applies new weights (edge, value) in place. Derived data that can follow
+// incrementally does; the rest is marked stale. The highlighted route is
+// re-derived so it never shows a path the new weights no longer prefer.
+void updateEdgeWeights(const std::vector<std::pair<CsrGraph::EdgeId, double>>& updates){
+    if (updates.empty()) return;
+    const bool hasRoute = pathIndices.size() >= 2;
+    const bool useTree = hasRoute && routeMetric == Metric::Distance;
+    if (useTree && (routeTree.empty() || routeTree.source() != (uint32_t)pathIndices.front() ||
+                    routeTree.graphVersion() != graph.version()))
+        routeTree = ShortestPathTree::build(graph, pathIndices.front());
+
+    std::vector<CsrGraph::EdgeId> changed;
+    for (const auto& [e, w] : updates){
+        graph.setEdgeWeight(e, w);
+        changed.push_back(e);
+        // A slower edge steepens its profile's falling slopes
+        const uint32_t profile = travelProfiles.profileOf(e);
+        if (profile != TravelTimeProfiles::kNone && !travelProfiles.fifo(profile, metricModel.edgeTime(graph, e))){
+            travelProfiles.detach(e);
+            std::cout << "Profile would break FIFO on " << nodes[graph.edgeTail(e)].name << "-"
+                      << nodes[graph.edgeHead(e)].name << ", now static\n";
+        }
+    }
+    if (pagedRouting) pagedRouting = patchPagedGraph(changed);
+    if (chainRouting) buildChainGraph();
+    customizeMetrics();
+    if (!preprocessingStale) std::cout << "CH, hub labels, landmarks and matrix are stale; press R to rebuild\n";
+    preprocessingStale = true;
+
+    if (!hasRoute) return;
+    const int start = pathIndices.front(), end = pathIndices.back();
+    std::vector<int> before = pathIndices;
+    if (useTree){
+        uint32_t touched = routeTree.repair(graph, changed);
+        pathIndices = routeTree.pathTo(end);
+        std::cout << "Route tree repaired, " << touched << " of " << graph.numNodes() << " nodes re-settled\n";
+    } else {
+        pathIndices = findShortestPath(start, end).first;
+    }
+    measurePath(pathIndices, routeMetric, totalPathDistance, totalPathTime, totalPathCost);
+    computeAlternatives(start, end);
+    if (pathIndices != before){
+        std::cout << "Route now: ";
+        for (size_t i=0;i<pathIndices.size();++i)
+            std::cout << nodes[pathIndices[i]].name << (i+1<pathIndices.size()? " -> ":"\n");
+    }
+    std::cout << "Total distance: " << totalPathDistance << "  time: " << totalPathTime << "H  cost: "
+              << totalPathCost << " " << kCurrency << "\n";
+}
+
+// Demo: multiplies the weight of every edge on the highlighted route.
+void scaleDisplayedRoute(double factor){
+    if (pathIndices.size() < 2) return;
+    std::vector<std::pair<CsrGraph::EdgeId, double>> updates;
+    for (size_t i=0; i+1<pathIndices.size(); ++i){
+        CsrGraph::EdgeId best = CsrGraph::kInvalid;
+        double bestValue = 0.0;
+        for (auto a=graph.arcBegin(pathIndices[i]); a<graph.arcEnd(pathIndices[i]); ++a){
+            if ((int)graph.arcTarget(a) != pathIndices[i+1]) continue;
+            const double value = metricModel.edgeValue(graph, graph.arcEdge(a), routeMetric);
+            if (best == CsrGraph::kInvalid || value < bestValue){ best = graph.arcEdge(a); bestValue = value; }
+        }
+        if (best != CsrGraph::kInvalid) updates.push_back({best, graph.edgeWeight(best) * factor});
+    }
+    std::cout << (factor > 1.0 ? "Slowing" : "Speeding up") << " " << updates.size() << " road(s) on the route\n";
+    updateEdgeWeights(updates);
+}
+
+void toggleAlternatives(Alternatives mode){
+    alternativesMode = alternativesMode == mode ? Alternatives::None : mode;
+    const char* name = mode == Alternatives::Pareto ? "Pareto alternatives" : "K shortest routes";
+    std::cout << name << (alternativesMode == mode ? " on" : " off") << "\n";
+    alternativeRoutes.clear();
+    if (pathIndices.size() >= 2) computeAlternatives(pathIndices.front(), pathIndices.back());
+}
+
+// Fills alternativeRoutes for the current alternatives mode, minus the route
+// already highlighted, and lists all of them in the terminal.
+void computeAlternatives(int start, int end){
+    alternativeRoutes.clear();
+    if (alternativesMode == Alternatives::None) return;
+
+    if (alternativesMode == Alternatives::KShortest){
+        auto t0 = std::chrono::steady_clock::now();
+        std::vector<RankedPath> ranked = KShortestPaths::find(graph, start, end, kShortestPathCount);
+        auto ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+        std::cout << ranked.size() << " shortest route(s) in " << std::fixed << std::setprecision(1) << ms << " ms\n";
+        for (size_t i=0; i<ranked.size(); ++i){
+            std::cout << "  #" << i+1 << "  " << std::setw(8) << ranked[i].distance << "  ";
+            for (size_t j=0;j<ranked[i].path.size();++j)
+                std::cout << nodes[ranked[i].path[j]].name << (j+1<ranked[i].path.size()? " -> ":"");
+            std::cout << (ranked[i].path == pathIndices ? "  (highlighted)\n" : "\n");
+            if (ranked[i].path != pathIndices) alternativeRoutes.push_back(ranked[i].path);
+        }
+        std::cout << std::defaultfloat << std::setprecision(6);
+        return;
+    }
+
+    buildMetrics();
+    ParetoRouter::EdgeWeights weights{ &metricWeights[(int)Metric::Distance], &metricWeights[(int)Metric::Time],
+                                       &metricWeights[(int)Metric::Cost] };
+    ParetoOptions options;
+    options.epsilon = kParetoEpsilon;
+    auto t0 = std::chrono::steady_clock::now();
+    std::vector<ParetoRouter::Route> routes = paretoRouter.search(graph, weights, start, end, options);
+    auto ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+
+    std::cout << routes.size() << " non-dominated route(s), " << paretoRouter.labelsCreated() << " labels in "
+              << std::fixed << std::setprecision(1) << ms << " ms" << (paretoRouter.truncated() ? " (label cap hit)" : "")
+              << "\n";
+    for (const auto& r : routes){
+        std::cout << "  " << std::setw(8) << r.costs[0] << "  " << std::setw(6) << r.costs[1] << "H  "
+                  << std::setw(8) << r.costs[2] << " " << kCurrency << "  ";
+        for (size_t i=0;i<r.path.size();++i) std::cout << nodes[r.path[i]].name << (i+1<r.path.size()? " -> ":"");
+        std::cout << (r.path == pathIndices ? "  (highlighted)\n" : "\n");
+        if (r.path != pathIndices) alternativeRoutes.push_back(r.path);
+    }
+    std::cout << std::defaultfloat << std::setprecision(6);
+}
+
+// Every city to every city, from one bucket many-to-many run on the CH
+// (plain searches while the CH is stale).
+void printDistanceTable(){
+    std::vector<int> all(graph.numNodes());
+    for (int v=0; v<(int)all.size(); ++v) all[v] = v;
+    auto t0 = std::chrono::steady_clock::now();
+    std::vector<double> table = preprocessingStale ? distanceTable(graph, all, all) : distanceTable(hierarchy, all, all);
+    auto ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+
+    const size_t n = all.size(), shown = std::min<size_t>(n, 12); // larger tables: top-left corner only
+    std::cout << std::setw(12) << "";
+    for (size_t j=0; j<shown; ++j) std::cout << std::setw(12) << nodes[j].name;
+    std::cout << "\n" << std::fixed << std::setprecision(0);
+    for (size_t i=0; i<shown; ++i){
+        std::cout << std::setw(12) << nodes[i].name;
+        for (size_t j=0; j<shown; ++j){
+            double d = table[i*n + j];
+            if (d == QueryContext::kInf) std::cout << std::setw(12) << "-";
+            else std::cout << std::setw(12) << d;
+        }
+        std::cout << "\n";
+    }
+    std::cout << std::setprecision(1) << n << "x" << n << " table in " << ms << " ms\n" << std::defaultfloat << std::setprecision(6);
+}
+
+// One-to-all distances from `source` by parallel delta-stepping, nearest
+// cities first.
+void printReachability(int source){
+    const double delta = DeltaStepping::suggestDelta(graph);
+    auto t0 = std::chrono::steady_clock::now();
+    std::vector<double> dist = DeltaStepping::run(graph, source, delta);
+    auto ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+
+    std::vector<int> reached;
+    double sum = 0.0;
+    for (int v=0; v<(int)dist.size(); ++v)
+        if (v != source && dist[v] != DeltaStepping::kInf){ reached.push_back(v); sum += dist[v]; }
+    std::sort(reached.begin(), reached.end(), [&](int a, int b){ return dist[a] < dist[b]; });
+
+    std::cout << "Reachable from " << nodes[source].name << ": " << reached.size() << " of " << dist.size()-1 << " cities";
+    if (!reached.empty()) std::cout << ", mean distance " << std::fixed << std::setprecision(0) << sum / reached.size();
+    std::cout << "\n" << std::fixed << std::setprecision(0);
+    for (size_t i=0; i<std::min<size_t>(reached.size(), 12); ++i) // larger graphs: nearest only
+        std::cout << "  " << std::setw(12) << nodes[reached[i]].name << std::setw(10) << dist[reached[i]] << "\n";
+    std::cout << "Delta-stepping (delta " << delta << ") in " << std::setprecision(1) << ms << " ms\n"
+              << std::defaultfloat << std::setprecision(6);
+}
+
+// Opens the cache on kPagedFile, writing the file first unless it already
+// holds the current graph.
+bool openPagedGraph(){
+    auto t0 = std::chrono::steady_clock::now();
+    std::string error;
+    bool current = pagedGraph.open(kPagedFile, kPageCacheBytes, error) && pagedGraph.pageBytes() == kPageBytes &&
+                   pagedGraph.fingerprint() == graph.fingerprint();
+    for (uint32_t v=0; current && v<graph.numNodes(); ++v) current = (int)pagedGraph.externalId(v) == externalId((int)v);
+    if (!current){
+        pagedGraph.close();  // the file is rewritten in place
+        if (!PagedGraph::write(kPagedFile, graph, nodes, externalIds, kPageBytes, error) ||
+            !pagedGraph.open(kPagedFile, kPageCacheBytes, error)){
+            std::cout << error << "\n";
+            return false;
+        }
+    }
+    pagedGraphVersion = graph.version();
+    auto ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    std::cout << "Paged graph: " << pagedGraph.numPages() << " pages of " << (kPageBytes >> 10) << " KB "
+              << (current ? "reused from " : "written to ") << kPagedFile << " in " << std::fixed << std::setprecision(1)
+              << ms << " ms, " << pagedGraph.cacheBytes() / pagedGraph.pageBytes() << " pages cached\n"
+              << std::defaultfloat << std::setprecision(6);
+    return true;
+}
+
+// Rewrites the weights of the pages holding `changed` and reopens the cache;
+// the whole file is only rewritten if patching fails.
+bool patchPagedGraph(const std::vector<CsrGraph::EdgeId>& changed){
+    std::vector<CsrGraph::NodeId> ends;
+    for (CsrGraph::EdgeId e : changed){ ends.push_back(graph.edgeTail(e)); ends.push_back(graph.edgeHead(e)); }
+    std::string error;
+    pagedGraph.close(); // not open for reading while it is written
+    if (!PagedGraph::patchWeights(kPagedFile, graph, ends, error)) std::cout << error << "\n";
+    return openPagedGraph();
+}
+
+// `--paged FROM TO`: distance route between two ids of kNodesFile read from
+// kPagedFile alone, so neither the network nor the window is loaded and the
+// arcs never have to fit in memory. The file must be current: newer than the
+// CSV files and not patched by weight updates (the viewer's D rewrites it).
+bool routeOnPagedFile(const std::string& from, const std::string& to){
+    std::string error;
+    if (!fileIsCurrent(kPagedFile)){
+        std::cout << kPagedFile << " is missing or older than " << kNodesFile << " / " << kEdgesFile
+                  << "; start the viewer and press D to write it\n";
+        return false;
+    }
+    if (!pagedGraph.open(kPagedFile, kPageCacheBytes, error)){ std::cout << error << "\n"; return false; }
+    if (pagedGraph.edited()){
+        std::cout << kPagedFile << " holds weights edited in the viewer; press D there to rewrite it\n";
+        return false;
+    }
+    int ends[2] = {-1, -1};
+    const std::string ids[2] = {from, to};
+    for (int i=0; i<2; ++i){
+        char* rest = nullptr;
+        const unsigned long id = std::strtoul(ids[i].c_str(), &rest, 10);
+        for (uint32_t v=0; v<pagedGraph.numNodes() && !ids[i].empty() && *rest == '\0'; ++v)
+            if (pagedGraph.externalId(v) == id){ ends[i] = (int)v; break; }
+        if (ends[i] < 0){ std::cout << "No node with id " << ids[i] << " in " << kPagedFile << "\n"; return false; }
+    }
+
+    QueryContext& ctx = threadQueryContext();
+    PagedGraph::threadStats() = PagedGraph::Stats{};
+    auto t0 = std::chrono::steady_clock::now();
+    const double d = dijkstra(pagedGraph, ends[0], ends[1], ctx);
+    auto ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    const PagedGraph::Stats pages = PagedGraph::threadStats();
+    if (pages.errors > 0){ std::cout << pages.errors << " page reads failed; no route\n"; return false; }
+    if (d == QueryContext::kInf){ std::cout << "No path between " << from << " and " << to << "\n"; return true; }
+
+    const std::vector<int> path = ctx.pathTo(ends[1]);
+    std::cout << "Path: ";
+    for (size_t i=0; i<path.size(); ++i) std::cout << pagedGraph.externalId(path[i]) << (i+1<path.size()? " -> ":"\n");
+    std::cout << "Total distance: " << d << "  (" << path.size() << " nodes, " << ctx.stats.settled << " settled, "
+              << pages.faults << " page faults, " << pages.hits << " hits, " << std::fixed << std::setprecision(1)
+              << ms << " ms)\n" << std::defaultfloat << std::setprecision(6);
+    return true;
+}
+
+void togglePagedRouting(){
+    pagedRouting = !pagedRouting && openPagedGraph();
+    if (!pagedRouting) pagedGraph.close();
+    std::cout << "Out-of-core routing " << (pagedRouting ? "on" : "off") << "\n";
+}
+
+// Renumbers a copy of the graph into every order and runs the same random
+// Dijkstra routes on it. Arc locality is printed as the cache-friendliness
+// measure (hardware counters are not portable), next to the time per route
+// relative to the order of the source data.
+void benchmarkNodeOrders(){
+    const uint32_t n = graph.numNodes();
+    if (n < 2) return;
+    std::vector<CsrGraph::NodeId> sourceOrder(n);
+    for (uint32_t v=0; v<n; ++v) sourceOrder[externalId((int)v)] = v;
+    std::mt19937 rng(1);
+    std::uniform_int_distribution<int> pick(0, (int)n-1);
+    std::vector<std::pair<int, int>> queries(kOrderBenchQueries);
+    for (auto& q : queries) q = {pick(rng), pick(rng)};
+
+    std::cout << "Node orders, " << queries.size() << " Dijkstra routes each:\n";
+    QueryContext ctx;
+    std::vector<double> reference;
+    double baseline = 0.0;
+    for (int s=0; s<(int)NodeOrder::Strategy::Count; ++s){
+        const auto strategy = (NodeOrder::Strategy)s;
+        std::vector<Node> renumberedNodes = nodes;
+        CsrGraph renumbered = graph;
+        std::vector<CsrGraph::NodeId> oldIds; // current id of every renumbered node
+        NodeOrder::apply(strategy == NodeOrder::Strategy::Input ? sourceOrder : NodeOrder::compute(strategy, nodes, graph),
+                         renumberedNodes, renumbered, oldIds);
+        std::vector<int> newId(n);
+        for (uint32_t v=0; v<n; ++v) newId[oldIds[v]] = (int)v;
+        const NodeOrder::Locality locality = NodeOrder::measure(renumbered);
+
+        dijkstra(renumbered, newId[queries[0].first], newId[queries[0].second], ctx); // warm up
+        std::vector<double> distances;
+        auto t0 = std::chrono::steady_clock::now();
+        for (const auto& q : queries) distances.push_back(dijkstra(renumbered, newId[q.first], newId[q.second], ctx));
+        auto ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count() / queries.size();
+        if (s == 0){ reference = distances; baseline = ms; }
+
+        std::cout << "  " << std::left << std::setw(21) << NodeOrder::name(strategy) << std::right << std::fixed
+                  << " arc gap 2^" << std::setprecision(2) << locality.meanGap
+                  << "  same line " << std::setprecision(1) << std::setw(5) << 100.0*locality.sameLine
+                  << "%  same page " << std::setw(5) << 100.0*locality.samePage
+                  << "%  " << std::setprecision(3) << ms << " ms/route  " << std::setprecision(2)
+                  << baseline / std::max(ms, 1e-9) << "x" << (strategy == kNodeOrder ? "  (in use)" : "");
+        for (size_t i=0; i<distances.size(); ++i){
+            if (std::abs(distances[i] - reference[i]) > 1e-6 * std::max(1.0, reference[i])){
+                std::cout << "  WARNING: route " << i << " differs";
+                break;
             }
         }
+        std::cout << "\n" << std::defaultfloat << std::setprecision(6);
     }
-    if (dist[end]==std::numeric_limits<double>::infinity()) return {{},0.0};
+}
 
-    std::vector<int> path;
-    for (int cur=end; cur!=-1; cur=parent[cur]) path.push_back(cur);
-    std::reverse(path.begin(), path.end());
-    return {path, dist[end]};
+// Zero-weight roads (same-coordinate nodes, 0 km CSV rows) are the corner
+// case: a via-path weighing 0 still needs its shortcut, and a hub-label path
+// has to take zero-weight hops. Paths are walked and summed arc by arc.
+// Weights are whole numbers, so the integer queues must match exactly too.
+void checkExactModes(){
+    enum Check { AStar, Bidirectional, BidirectionalAStar, CH, Labels, LabelPaths, CCH, CCHPaths, ALT, Matrix, MatrixPaths,
+                 Chains, ChainPaths, Paged, Dial, Radix, BinaryHeap, Delta, CheckCount };
+    static const char* names[CheckCount] = {"A*", "bidirectional", "bidirectional A*", "CH", "hub labels", "hub-label paths",
+                                            "CCH", "CCH paths", "ALT", "matrix", "matrix paths", "chains", "chain paths",
+                                            "paged", "Dial", "radix heap", "binary heap", "delta-stepping"};
+    uint64_t checked[CheckCount] = {}, wrong[CheckCount] = {};
+    auto differs = [](double a, double b){ return a != b && !(std::abs(a - b) <= 1e-9); };
+    auto report = [&](Check c, bool bad, int graph, int s, int t, double got, double expected){
+        ++checked[c];
+        if (bad && wrong[c]++ == 0)
+            std::cout << "  " << names[c] << ", graph " << graph << ", " << s << " -> " << t << ": "
+                      << got << " vs Dijkstra " << expected << "\n";
+    };
+    auto pathLength = [](const CsrGraph& g, const std::vector<int>& path){
+        double length = 0.0;
+        for (size_t i=1; i<path.size(); ++i){
+            double best = QueryContext::kInf;
+            g.forEachArc((CsrGraph::NodeId)path[i-1], [&](CsrGraph::NodeId v, double w){
+                if ((int)v == path[i]) best = std::min(best, w);
+            });
+            length += best;
+        }
+        return length;
+    };
+    auto badPath = [&](const CsrGraph& g, const std::vector<int>& path, int s, int t, double expected){
+        return path.empty() || path.front() != s || path.back() != t || differs(pathLength(g, path), expected);
+    };
+    auto units = [](uint32_t u){ return u == QuantizedGraph::kInf ? QueryContext::kInf : (double)u; };
+
+    const std::string pagedCheckFile = (std::filesystem::temp_directory_path() / "pathfinder_check.pages").string();
+    std::mt19937 rng(1);
+    QueryContext ctx, modeCtx;
+    BidirectionalContext bctx;
+    IntegerQueryContext<DialQueue> dialCtx;
+    IntegerQueryContext<RadixHeap> radixCtx;
+    IntegerQueryContext<BinaryHeapQueue> heapCtx;
+    PagedGraph paged;
+    std::string error;
+    for (int i=0; i<kCheckGraphs; ++i){
+        const bool large = i % kCheckLargeEvery == kCheckLargeEvery - 1;
+        const int n = large ? (int)DistanceMatrix::kTile + 1 + (int)(rng() % (kCheckLargeNodes - DistanceMatrix::kTile))
+                            : 2 + (int)(rng() % (kCheckMaxNodes - 1));
+        std::uniform_int_distribution<int> pick(0, n-1);
+        std::uniform_real_distribution<float> coordinate(-1.0f, 1.0f);
+        std::vector<WeightedLine> roads(n + rng() % (2*n));
+        for (auto& r : roads) r = WeightedLine(pick(rng), pick(rng), rng() % 3 == 0 ? 0.0 : 1.0 + rng() % 10);
+        // Nodes joined by zero-weight roads share one spot, so the Euclidean
+        // scale stays above 0 and A* is actually guided.
+        std::vector<int> spot(n);
+        for (int v=0; v<n; ++v) spot[v] = v;
+        auto spotOf = [&](int v){ while (spot[v] != v) v = spot[v] = spot[spot[v]]; return v; };
+        for (const auto& r : roads) if (r.weight == 0.0) spot[spotOf(r.start)] = spotOf(r.end);
+        std::vector<std::pair<float, float>> spots(n);
+        for (auto& xy : spots) xy = {coordinate(rng), coordinate(rng)};
+        std::vector<Node> checkNodes;
+        for (int v=0; v<n; ++v) checkNodes.emplace_back(spots[spotOf(v)].first, spots[spotOf(v)].second, std::to_string(v));
+        const CsrGraph g = CsrGraph::build(n, roads);
+        const double scale = calibrateEuclideanScale(checkNodes, g);
+        std::vector<double> weights(g.numEdges());
+        for (CsrGraph::EdgeId e=0; e<g.numEdges(); ++e) weights[e] = g.edgeWeight(e);
+
+        const ContractionHierarchy ch = ContractionHierarchy::build(g);
+        std::vector<CsrGraph::NodeId> importance(n);
+        for (int v=0; v<n; ++v) importance[n-1-ch.rank(v)] = v;
+        const HubLabels labels = HubLabels::build(g, importance);
+        const CustomizableCH cch = CustomizableCH::build(g, checkNodes);
+        const CustomizableCH::Customization customization = cch.customize(weights);
+        const LandmarkTable landmarks = LandmarkTable::build(g, std::min<uint32_t>(4, n), LandmarkTable::Selection::Avoid);
+        const ChainGraph chains = ChainGraph::build(g);
+        const DistanceMatrix matrix = DistanceMatrix::build(g);
+        QuantizedGraph quantized;
+        const bool integer = QuantizedGraph::build(g, weights, 1.0, quantized, error);
+        if (!integer) std::cout << "  graph " << i << ": " << error << "\n";
+        const bool pagedOpen = PagedGraph::write(pagedCheckFile, g, checkNodes, {}, 1024, error) &&
+                               paged.open(pagedCheckFile, 0, error); // smallest cache, so pages get evicted
+        if (!pagedOpen) std::cout << "  graph " << i << ": " << error << "\n";
+
+        std::vector<int> sources;
+        for (int s=0; s<n; ++s) sources.push_back(s);
+        if (large){
+            std::shuffle(sources.begin(), sources.end(), rng);
+            sources.resize(kCheckLargeSources);
+        }
+        for (int s : sources){
+            for (int t=0; t<n; ++t){
+                const double expected = dijkstra(g, s, t, ctx);
+                double got = ch.query(s, t, bctx).distance;
+                report(CH, differs(got, expected), i, s, t, got, expected);
+                got = labels.distance(s, t);
+                report(Labels, differs(got, expected), i, s, t, got, expected);
+                BidirectionalResult r = cch.query(s, t, customization, bctx);
+                report(CCH, differs(r.distance, expected), i, s, t, r.distance, expected);
+                if (expected != QueryContext::kInf){
+                    std::vector<int> path = labels.path(g, s, t);
+                    report(LabelPaths, badPath(g, path, s, t, expected), i, s, t, pathLength(g, path), expected);
+                    path = r.meet < 0 ? std::vector<int>() : cch.unpackPath(bctx, r.meet, customization);
+                    report(CCHPaths, badPath(g, path, s, t, expected), i, s, t, pathLength(g, path), expected);
+                }
+                got = astar(g, s, t, modeCtx, AltPotential(landmarks, t));
+                report(ALT, differs(got, expected), i, s, t, got, expected);
+                EuclideanPotential toEnd(checkNodes, scale, t), toStart(checkNodes, scale, s);
+                got = astar(g, s, t, modeCtx, toEnd);
+                report(AStar, differs(got, expected), i, s, t, got, expected);
+                got = bidirectionalSearch(g, g, s, t, bctx, ZeroPotential{}, ZeroPotential{}).distance;
+                report(Bidirectional, differs(got, expected), i, s, t, got, expected);
+                got = bidirectionalSearch(g, g, s, t, bctx, AveragedPotential<EuclideanPotential>(toEnd, toStart, false),
+                                          AveragedPotential<EuclideanPotential>(toEnd, toStart, true)).distance;
+                report(BidirectionalAStar, differs(got, expected), i, s, t, got, expected);
+                got = matrix.distance(s, t);
+                report(Matrix, differs(got, expected), i, s, t, got, expected);
+                if (expected != QueryContext::kInf){
+                    const std::vector<int> path = matrix.path(s, t);
+                    report(MatrixPaths, badPath(g, path, s, t, expected), i, s, t, pathLength(g, path), expected);
+                }
+
+                const ChainGraph::View view = chains.view(s, t);
+                got = dijkstra(view, s, t, modeCtx);
+                report(Chains, differs(got, expected), i, s, t, got, expected);
+                if (expected != QueryContext::kInf){
+                    const std::vector<int> path = view.expand(modeCtx.pathTo(t));
+                    report(ChainPaths, badPath(g, path, s, t, expected), i, s, t, pathLength(g, path), expected);
+                }
+                if (pagedOpen){
+                    got = dijkstra(paged, s, t, modeCtx);
+                    report(Paged, differs(got, expected), i, s, t, got, expected);
+                }
+                if (integer){
+                    got = units(integerDijkstra(quantized, s, t, dialCtx));
+                    report(Dial, differs(got, expected), i, s, t, got, expected);
+                    got = units(integerDijkstra(quantized, s, t, radixCtx));
+                    report(Radix, differs(got, expected), i, s, t, got, expected);
+                    got = units(integerDijkstra(quantized, s, t, heapCtx));
+                    report(BinaryHeap, differs(got, expected), i, s, t, got, expected);
+                }
+            }
+        }
+
+        // Delta-stepping is one-to-all: one source, every target
+        const int source = pick(rng);
+        dijkstra(g, source, -1, ctx);
+        for (double delta : kCheckDeltas){
+            const std::vector<double> dist = DeltaStepping::run(g, source, delta);
+            int bad = 0;
+            while (bad+1 < n && !differs(dist[bad], ctx.dist(bad))) ++bad;
+            report(Delta, differs(dist[bad], ctx.dist(bad)), i, source, bad, dist[bad], ctx.dist(bad));
+        }
+    }
+    paged.close();
+    std::error_code ec;
+    std::filesystem::remove(pagedCheckFile, ec);
+
+    std::cout << "Exact-mode check on " << kCheckGraphs << " random graphs, differences from Dijkstra:\n";
+    for (int c=0; c<CheckCount; ++c)
+        std::cout << "  " << std::left << std::setw(16) << names[c] << std::right << std::setw(8) << wrong[c]
+                  << " of " << checked[c] << (c == Delta ? " one-to-all runs\n" : " pairs\n");
+}
+
+void buildChainGraph(){
+    auto t0 = std::chrono::steady_clock::now();
+    chainGraph = ChainGraph::build(graph);
+    chainGraphVersion = graph.version();
+    auto ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    std::cout << "Chain graph: " << chainGraph.numJunctionNodes() << " of " << graph.numNodes() << " nodes kept ("
+              << std::fixed << std::setprecision(1) << (double)graph.numNodes() / std::max(1u, chainGraph.numJunctionNodes())
+              << "x fewer), " << chainGraph.numChains() << " chains, " << chainGraph.numArcs() << " arcs, "
+              << chainGraph.sizeBytes() << " bytes in " << ms << " ms\n" << std::defaultfloat << std::setprecision(6);
+}
+
+void toggleChainRouting(){
+    chainRouting = !chainRouting;
+    if (chainRouting) buildChainGraph();
+    else chainGraph = ChainGraph();
+    std::cout << "Chain routing " << (chainRouting ? "on" : "off") << "\n";
+}
+
+// Times the same random routes (current metric, static weights) with the
+// double/binary-heap Dijkstra and with integer weights under each queue,
+// and prints how far the quantized distances stray.
+template<class Queue>
+double timeIntegerQueue(const QuantizedGraph& q, const std::vector<std::pair<int, int>>& queries,
+                        std::vector<uint32_t>& units, uint64_t& settled){
+    IntegerQueryContext<Queue>& ctx = threadIntegerQueryContext<Queue>();
+    integerDijkstra(q, queries[0].first, queries[0].second, ctx); // warm up
+    units.clear(); settled = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for (const auto& r : queries){ units.push_back(integerDijkstra(q, r.first, r.second, ctx)); settled += ctx.stats.settled; }
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count() / queries.size();
+}
+
+void benchmarkQueues(){
+    if (!quantizedReady) quantizeMetrics();
+    const QuantizedGraph& q = quantizedGraphs[(int)routeMetric];
+    if (graph.numNodes() < 2 || q.empty()){ std::cout << "No integer weights for " << metricName(routeMetric) << "\n"; return; }
+    std::mt19937 rng(1);
+    std::uniform_int_distribution<int> pick(0, (int)graph.numNodes()-1);
+    std::vector<std::pair<int, int>> queries(kQueueBenchQueries);
+    for (auto& r : queries) r = {pick(rng), pick(rng)};
+
+    const MetricView weights(graph, metricWeights[(int)routeMetric]);
+    QueryContext& ctx = threadQueryContext();
+    dijkstra(weights, queries[0].first, queries[0].second, ctx);
+    std::vector<double> reference;
+    uint64_t settled = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for (const auto& r : queries){ reference.push_back(dijkstra(weights, r.first, r.second, ctx)); settled += ctx.stats.settled; }
+    const double baseline = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count() / queries.size();
+
+    std::cout << "Dijkstra queues, " << queries.size() << " routes by " << metricName(routeMetric) << " (weights x"
+              << kQuantizedUnits[(int)routeMetric] << ", largest arc " << q.maxArcWeight() << " units):\n";
+    auto report = [&](const char* name, double ms, uint64_t popped, const std::vector<uint32_t>* units){
+        std::cout << "  " << std::left << std::setw(16) << name << std::right << std::fixed << std::setprecision(3)
+                  << ms << " ms/route  " << std::setprecision(2) << baseline / std::max(ms, 1e-9) << "x  "
+                  << std::setprecision(1) << (double)popped / queries.size() << " settled";
+        if (units){
+            double worst = 0.0;
+            for (size_t i=0; i<queries.size(); ++i){
+                if (reference[i] == QueryContext::kInf) continue;
+                worst = std::max(worst, std::abs(q.toWeight((*units)[i]) - reference[i]));
+            }
+            std::cout << "  max error " << std::setprecision(4) << worst;
+        }
+        std::cout << "\n" << std::defaultfloat << std::setprecision(6);
+    };
+    report("double, binary", baseline, settled, nullptr);
+    std::vector<uint32_t> units;
+    double ms = timeIntegerQueue<BinaryHeapQueue>(q, queries, units, settled);
+    report("integer, binary", ms, settled, &units);
+    ms = timeIntegerQueue<RadixHeap>(q, queries, units, settled);
+    report("integer, radix", ms, settled, &units);
+    if (q.maxArcWeight() <= kDialMaxWeight){
+        ms = timeIntegerQueue<DialQueue>(q, queries, units, settled);
+        report("integer, Dial", ms, settled, &units);
+    } else {
+        std::cout << "  integer, Dial   skipped, largest arc is over " << kDialMaxWeight << " units\n";
+    }
+}
+
+// Queues kBatchQueries random routes in the current mode and metric. The
+// answers arrive in the background; batchRunning() reports them.
+void startBatch(){
+    if (batchRunning()){ std::cout << "A batch is already running\n"; return; }
+    std::vector<std::pair<int, int>> queries(kBatchQueries);
+    std::mt19937 rng((uint32_t)std::chrono::steady_clock::now().time_since_epoch().count());
+    std::uniform_int_distribution<int> pick(0, (int)graph.numNodes()-1);
+    for (auto& q : queries) q = {pick(rng), pick(rng)};
+
+    const RouteMode mode = routeMode;
+    const Metric metric = routeMetric;
+    prepareRouting(mode, metric);
+    batchMode = mode;
+    batchSettled = 0;
+    batchPages = pagedGraph.totals();
+    batchStarted = std::chrono::steady_clock::now();
+    batchResult = sharedPool().submitBatch(std::move(queries),
+        [mode, metric](const std::pair<int, int>& q){ return findShortestPath(q.first, q.second, mode, metric).second; },
+        [](size_t, double){ batchSettled.fetch_add(lastQueryStats.settled, std::memory_order_relaxed); });
+    std::cout << "Batch of " << kBatchQueries << " routes queued (" << routeModeName(mode) << ", "
+              << metricName(metric) << ")\n";
+}
+
+// True while a batch is in flight; prints its summary once it has finished.
+bool batchRunning(){
+    if (!batchResult.valid()) return false;
+    if (batchResult.wait_for(std::chrono::seconds(0)) != std::future_status::ready) return true;
+    std::vector<double> distances = batchResult.get();
+    auto s = std::chrono::duration<double>(std::chrono::steady_clock::now() - batchStarted).count();
+    size_t found = 0;
+    for (double d : distances) if (d > 0.0) ++found;
+    std::cout << "Batch done: " << distances.size() << " routes (" << found << " non-trivial) in " << std::fixed
+              << std::setprecision(2) << s << " s, " << std::setprecision(0) << distances.size() / std::max(s, 1e-9)
+              << " routes/s, " << std::setprecision(1) << (double)batchSettled / std::max<size_t>(distances.size(), 1)
+              << " settled per route (" << routeModeName(batchMode) << ")\n" << std::defaultfloat << std::setprecision(6);
+    const PagedGraph::Stats pages = pagedGraph.totals();
+    if (pages.faults + pages.hits > batchPages.faults + batchPages.hits)
+        std::cout << "Pages: " << pages.faults - batchPages.faults << " faults, " << pages.hits - batchPages.hits
+                  << " hits, " << pages.prefetched - batchPages.prefetched << " prefetched\n";
+    if (pages.errors > batchPages.errors)
+        std::cout << "Page reads failed: " << pages.errors - batchPages.errors << " (those routes fell back to memory)\n";
+    return false;
+}
+
+void cycleIsochrone(){
+    if (!isochroneOn){ isochroneOn = true; isochroneMetric = Metric::Time; }
+    else if (isochroneMetric == Metric::Time) isochroneMetric = Metric::Cost;
+    else if (isochroneMetric == Metric::Cost) isochroneMetric = Metric::Distance;
+    else isochroneOn = false;
+    isochroneShown = -1.0;
+    if (!isochroneOn){ std::cout << "Isochrone off\n"; return; }
+    std::cout << "Isochrone by " << metricName(isochroneMetric) << ", budget " << isochroneBudget[(int)isochroneMetric] << "\n";
+    if (lastClickedNodeIndex == -1) std::cout << "Click a city to grow it from\n";
+}
+
+void scaleIsochroneBudget(double factor){
+    if (!isochroneOn) return;
+    isochroneBudget[(int)isochroneMetric] *= factor;
+}
+
+// Brings the isochrone up to date with the clicked city, the weights and the
+// budget. The search resumes instead of restarting when only the budget
+// grew, so this is cheap to call every frame.
+void refreshIsochrone(){
+    if (!isochroneOn || lastClickedNodeIndex == -1) return;
+    buildMetrics();
+    const std::vector<double>& weights = metricWeights[(int)isochroneMetric];
+    if (isochrone.empty() || isochrone.source() != (uint32_t)lastClickedNodeIndex ||
+        isochrone.graphVersion() != graph.version() || isochrone.weights() != &weights){
+        isochrone.reset(graph, weights, lastClickedNodeIndex);
+        isochroneShown = -1.0;
+    }
+    const double budget = isochroneBudget[(int)isochroneMetric];
+    if (budget == isochroneShown) return;
+    auto t0 = std::chrono::steady_clock::now();
+    isochrone.extendTo(budget);
+
+    struct MapPoint { float x, y; };
+    std::vector<MapPoint> outline;
+    std::vector<uint32_t> inside = isochrone.nodesWithin(budget);
+    for (uint32_t v : inside) outline.push_back({nodes[v].x, nodes[v].y});
+    isochroneLines.clear();
+    for (const auto& seg : isochrone.segmentsWithin(budget)){
+        const Node& a = nodes[seg.from];
+        const Node& b = nodes[seg.to];
+        const float f = (float)seg.fraction;
+        const MapPoint end{a.x + (b.x - a.x)*f, a.y + (b.y - a.y)*f};
+        isochroneLines.insert(isochroneLines.end(), {a.x, a.y, 0.0f, end.x, end.y, 0.0f});
+        outline.push_back(end);
+    }
+    isochroneArea.clear();
+    for (const MapPoint& p : convexHull(outline)) isochroneArea.insert(isochroneArea.end(), {p.x, p.y, 0.0f});
+    auto ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+
+    std::cout << "Within " << std::fixed << std::setprecision(1) << budget
+              << (isochroneMetric == Metric::Time ? "H" : isochroneMetric == Metric::Cost ? " BDT" : " KM")
+              << " of " << nodes[lastClickedNodeIndex].name << ": " << inside.size()-1 << " cities";
+    for (size_t i=1; i<std::min<size_t>(inside.size(), 12); ++i) std::cout << (i==1 ? " (" : ", ") << nodes[inside[i]].name;
+    std::cout << (inside.size() > 12 ? ", ...)" : inside.size() > 1 ? ")" : "") << " in " << std::setprecision(2) << ms
+              << " ms\n" << std::defaultfloat << std::setprecision(6);
+    isochroneShown = budget;
+}
+
+// Translucent hull under the reachable roads, which may end part-way.
+void drawIsochrone(){
+    if (!isochroneOn || isochroneShown < 0.0 || isochroneLines.empty()) return;
+    GLuint vao,vbo;
+    glGenVertexArrays(1,&vao);
+    glGenBuffers(1,&vbo);
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glVertexAttribPointer(0,3,GL_FLOAT,GL_FALSE,3*sizeof(float),(void*)0);
+    glEnableVertexAttribArray(0);
+
+    int nodeColor = glGetUniformLocation(shaderProgram,"nodeColor");
+    int alphaLoc  = glGetUniformLocation(shaderProgram,"uAlpha");
+    if (isochroneArea.size() >= 9){
+        glBufferData(GL_ARRAY_BUFFER, isochroneArea.size()*sizeof(float), isochroneArea.data(), GL_STREAM_DRAW);
+        glUniform3f(nodeColor, 0.20f,0.75f,0.85f);
+        glUniform1f(alphaLoc, 0.18f);
+        glDrawArrays(GL_TRIANGLE_FAN, 0, (GLsizei)(isochroneArea.size()/3));
+    }
+    glBufferData(GL_ARRAY_BUFFER, isochroneLines.size()*sizeof(float), isochroneLines.data(), GL_STREAM_DRAW);
+    glUniform3f(nodeColor, 0.20f,0.75f,0.85f);
+    glUniform1f(alphaLoc, 1.0f);
+    glDrawArrays(GL_LINES, 0, (GLsizei)(isochroneLines.size()/3));
+
+    glDeleteBuffers(1,&vbo);
+    glDeleteVertexArrays(1,&vao);
+}
+
+// Distance, time and cost along `path`. Between two consecutive nodes the
+// edge that is best for `metric` is the one the router used. Values are
+// computed per edge, so a plain distance route needs no metric vectors.
+void measurePath(const std::vector<int>& path, Metric metric, double& distance, double& hours, double& cost){
+    distance = hours = cost = 0.0;
+    for (size_t i=0; i+1<path.size(); ++i){
+        CsrGraph::EdgeId best = CsrGraph::kInvalid;
+        double bestValue = 0.0;
+        for (auto a=graph.arcBegin(path[i]); a<graph.arcEnd(path[i]); ++a){
+            if ((int)graph.arcTarget(a) != path[i+1]) continue;
+            CsrGraph::EdgeId e = graph.arcEdge(a);
+            const double value = metricModel.edgeValue(graph, e, metric);
+            if (best == CsrGraph::kInvalid || value < bestValue){ best = e; bestValue = value; }
+        }
+        if (best == CsrGraph::kInvalid) continue;
+        distance += graph.edgeWeight(best);
+        hours    += travelProfiles.travelTime(best, departureHour + hours, metricModel.edgeTime(graph, best));
+        cost     += metricModel.edgeCost(graph, best);
+    }
 }
 
 // ---------------- Path info labels (HUD) ----------------
@@ -743,14 +2115,16 @@ void drawPathInfoLabels(){
     ssDist << (int)std::round(totalPathDistance) << "KM";
     std::string distTxt = ssDist.str();
 
-    // 2) Estimated time (decimal hours, 1dp)
-    double hours = (kSpeedUnitsPerHour>0.0) ? (totalPathDistance / kSpeedUnitsPerHour) : 0.0;
+    // 2) Estimated time (decimal hours, 1dp) from the per-edge speeds and
+    //    profiles, with the departure hour when the clock matters
+    double hours = totalPathTime;
     std::ostringstream ssTime;
     ssTime << std::fixed << std::setprecision(1) << hours << "H";
+    if (!travelProfiles.empty()) ssTime << " DEP " << (int)departureHour;
     std::string timeTxt = ssTime.str();
 
-    // 3) Cost
-    double cost = totalPathDistance * kCostPerUnit;
+    // 3) Cost, including tolls
+    double cost = totalPathCost;
     std::ostringstream ssCost;
     ssCost << "COST " << kCurrency << " " << std::fixed << std::setprecision(1) << cost;
     std::string costTxt = ssCost.str();
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+
+#include "graph.h"
+#include "dijkstra.h"
+#include "contraction_hierarchy.h"
+#include "parallel.h"
+
+// ---------------- Many-to-many distance tables ----------------
+// distanceTable(..., sources, targets) returns a dense row-major matrix:
+// entry [i*targets.size() + j] is d(sources[i], targets[j]), kInf if
+// unreachable.
+
+// Fallback on any graph: one full search per source, sources in parallel.
+template<class Graph>
+std::vector<double> distanceTable(const Graph& g, const std::vector<int>& sources, const std::vector<int>& targets){
+    const size_t cols = targets.size();
+    std::vector<double> table(sources.size()*cols, QueryContext::kInf);
+    parallelFor(0, sources.size(), [&](size_t i){
+        QueryContext& ctx = threadQueryContext();
+        dijkstra(g, sources[i], -1, ctx);
+        for (size_t j=0; j<cols; ++j) table[i*cols + j] = ctx.dist(targets[j]);
+    }, 1);
+    return table;
+}
+
+// Bucket many-to-many on a CH. Every shortest path is up-down, so:
+//  1. an upward search from each target leaves (target, d) in the bucket of
+//     every node it settles;
+//  2. an upward search from each source scans the buckets of the nodes it
+//     settles and keeps the best d_s(u) + d_t(u) per target.
+// That is |S| + |T| small searches instead of |S| * |T| queries. Both phases
+// run one search per task in parallel; buckets are read-only in phase 2.
+inline std::vector<double> distanceTable(const ContractionHierarchy& ch, const std::vector<int>& sources,
+                                         const std::vector<int>& targets){
+    struct Entry { uint32_t column; double dist; };
+    const uint32_t n = ch.numNodes();
+    const size_t cols = targets.size();
+
+    // Upward search with stall-on-demand; f(u, d) for every unstalled settle.
+    auto upwardSearch = [&](int from, QueryContext& q, auto&& f){
+        q.reset(n);
+        q.setLabel(from, 0.0, -1); q.push(0.0, from);
+        while (!q.empty()){
+            auto [d, u] = q.pop();
+            if (d > q.dist(u)) continue;
+            bool stalled = false;
+            ch.forEachArc((CsrGraph::NodeId)u, [&](CsrGraph::NodeId x, double w){ if (q.dist((int)x) + w < d) stalled = true; });
+            if (stalled) continue;
+            f((uint32_t)u, d);
+            ch.forEachArc((CsrGraph::NodeId)u, [&](CsrGraph::NodeId v, double w){
+                double nd = d + w;
+                if (nd < q.dist((int)v)){ q.setLabel((int)v, nd, u); q.push(nd, (int)v); }
+            });
+        }
+    };
+
+    // Phase 1: per-target search spaces, then bucket them by node (CSR).
+    std::vector<std::vector<std::pair<uint32_t,double>>> spaces(cols);
+    parallelFor(0, cols, [&](size_t j){
+        upwardSearch(targets[j], threadQueryContext(), [&](uint32_t u, double d){ spaces[j].push_back({u, d}); });
+    }, 1);
+    std::vector<uint32_t> bucketOffsets(n+1, 0);
+    for (const auto& space : spaces) for (const auto& [u, d] : space) ++bucketOffsets[u+1];
+    for (uint32_t v=0; v<n; ++v) bucketOffsets[v+1] += bucketOffsets[v];
+    std::vector<Entry> buckets(bucketOffsets[n]);
+    {
+        std::vector<uint32_t> fill(bucketOffsets.begin(), bucketOffsets.end()-1);
+        for (size_t j=0; j<cols; ++j){
+            for (const auto& [u, d] : spaces[j]) buckets[fill[u]++] = {(uint32_t)j, d};
+            std::vector<std::pair<uint32_t,double>>().swap(spaces[j]);
+        }
+    }
+
+    // Phase 2: each source fills its own row.
+    std::vector<double> table(sources.size()*cols, QueryContext::kInf);
+    parallelFor(0, sources.size(), [&](size_t i){
+        double* row = &table[i*cols];
+        upwardSearch(sources[i], threadQueryContext(), [&](uint32_t u, double d){
+            for (uint32_t b=bucketOffsets[u]; b<bucketOffsets[u+1]; ++b)
+                row[buckets[b].column] = std::min(row[buckets[b].column], d + buckets[b].dist);
+        });
+    }, 1);
+    return table;
+}
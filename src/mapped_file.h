@@ -0,0 +1,93 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// ---------------- Read-only memory-mapped file ----------------
+// The whole file as one byte range, paged in by the OS on demand. Move-only;
+// the mapping is released with the object. An empty file maps to an empty
+// range rather than failing. The access hint tunes read-ahead: Sequential
+// for files parsed front to back, Random for files queried in place.
+class MappedFile {
+public:
+    enum class Access { Sequential, Random };
+
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& o) noexcept { swap(o); }
+    MappedFile& operator=(MappedFile&& o) noexcept { if (this != &o){ close(); swap(o); } return *this; }
+    ~MappedFile(){ close(); }
+
+    bool open(const std::string& path, Access access = Access::Sequential){
+        close();
+#ifdef _WIN32
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                  access == Access::Random ? FILE_FLAG_RANDOM_ACCESS : FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE) return false;
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size)){ CloseHandle(file); return false; }
+        length = (size_t)size.QuadPart;
+        if (length > 0){
+            HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (mapping) bytes = (const char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            if (mapping) CloseHandle(mapping); // the view keeps the mapping alive
+        }
+        CloseHandle(file);
+        if (length > 0 && !bytes){ length = 0; return false; }
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0){ ::close(fd); return false; }
+        length = (size_t)st.st_size;
+        if (length > 0){
+            void* p = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p == MAP_FAILED){ ::close(fd); length = 0; return false; }
+            bytes = (const char*)p;
+            madvise(p, length, access == Access::Random ? MADV_RANDOM : MADV_SEQUENTIAL);
+        }
+        ::close(fd); // the mapping outlives the descriptor
+#endif
+        mapped = true;
+        return true;
+    }
+
+    void close(){
+        if (bytes){
+#ifdef _WIN32
+            UnmapViewOfFile(bytes);
+#else
+            munmap((void*)bytes, length);
+#endif
+        }
+        bytes = nullptr; length = 0; mapped = false;
+    }
+
+    bool isOpen() const { return mapped; }
+    const char* data() const { return bytes; }
+    size_t size() const { return length; }
+
+private:
+    void swap(MappedFile& o){ std::swap(bytes, o.bytes); std::swap(length, o.length); std::swap(mapped, o.mapped); }
+
+    const char* bytes = nullptr;
+    size_t length = 0;
+    bool mapped = false;
+};
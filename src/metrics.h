@@ -0,0 +1,65 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include "graph.h"
+
+// ---------------- Routing metrics ----------------
+// Distance is the WeightedLine weight itself. Time divides it by the edge's
+// own speed (or the network default) and cost adds the edge toll to the
+// per-distance fare, so the three metrics can prefer different routes.
+enum class Metric { Distance, Time, Cost, Count };
+
+inline const char* metricName(Metric m){
+    switch (m){
+        case Metric::Distance: return "distance";
+        case Metric::Time:     return "time";
+        case Metric::Cost:     return "cost";
+        default:               return "?";
+    }
+}
+
+// Network-wide defaults the per-edge values fall back to.
+struct MetricModel {
+    double defaultSpeed = 50.0; // distance-units per hour
+    double costPerUnit  = 3.2;  // currency per distance-unit
+
+    double edgeTime(const CsrGraph& g, CsrGraph::EdgeId e) const {
+        double speed = g.edgeSpeed(e) > 0.0 ? g.edgeSpeed(e) : defaultSpeed;
+        return speed > 0.0 ? g.edgeWeight(e) / speed : 0.0;
+    }
+    double edgeCost(const CsrGraph& g, CsrGraph::EdgeId e) const {
+        return g.edgeWeight(e) * costPerUnit + g.edgeToll(e);
+    }
+    double edgeValue(const CsrGraph& g, CsrGraph::EdgeId e, Metric m) const {
+        switch (m){
+            case Metric::Time: return edgeTime(g, e);
+            case Metric::Cost: return edgeCost(g, e);
+            default:           return g.edgeWeight(e);
+        }
+    }
+
+    // One value per undirected edge, indexed by EdgeId.
+    std::vector<double> edgeWeights(const CsrGraph& g, Metric m) const {
+        std::vector<double> w(g.numEdges());
+        for (CsrGraph::EdgeId e=0; e<g.numEdges(); ++e) w[e] = edgeValue(g, e, m);
+        return w;
+    }
+};
+
+// CsrGraph topology seen through a per-edge weight vector, so the generic
+// searches in dijkstra.h can run on any metric without another copy.
+class MetricView {
+public:
+    MetricView(const CsrGraph& g_, const std::vector<double>& edgeWeights_) : g(&g_), edgeWeights(&edgeWeights_) {}
+
+    uint32_t numNodes() const { return g->numNodes(); }
+    template<class F> void forEachArc(CsrGraph::NodeId u, F&& f) const {
+        for (auto a=g->arcBegin(u); a<g->arcEnd(u); ++a) f(g->arcTarget(a), (*edgeWeights)[g->arcEdge(a)]);
+    }
+
+private:
+    const CsrGraph* g;
+    const std::vector<double>* edgeWeights;
+};
@@ -0,0 +1,218 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cmath>
+#include <numeric>
+#include <algorithm>
+
+#include "graph.h"
+#include "parallel.h"
+
+// ---------------- Node ordering ----------------
+// Renumbers the nodes of a graph so that nodes close together on the map (or
+// a few hops apart) get close ids. Searches keep their labels in arrays
+// indexed by node id, and CsrGraph keeps the arcs of consecutive nodes next
+// to each other, so with a local order most relaxations touch cache lines
+// and pages that are already in cache.
+//
+// An order lists the old id of every new node: order[newId] = oldId. apply()
+// permutes coordinates, names and adjacency together; edge ids do not change,
+// so per-edge data (speeds, tolls, metric weights, travel-time profiles)
+// stays valid.
+class NodeOrder {
+public:
+    using NodeId = CsrGraph::NodeId;
+
+    enum class Strategy { Input, Hilbert, BreadthFirst, Bisection, Count };
+
+    static const char* name(Strategy s){
+        switch (s){
+            case Strategy::Input:        return "input";
+            case Strategy::Hilbert:      return "Hilbert curve";
+            case Strategy::BreadthFirst: return "breadth-first";
+            case Strategy::Bisection:    return "coordinate bisection";
+            default:                     return "?";
+        }
+    }
+
+    static std::vector<NodeId> compute(Strategy s, const std::vector<Node>& nodes, const CsrGraph& g){
+        switch (s){
+            case Strategy::Hilbert:      return hilbert(nodes);
+            case Strategy::BreadthFirst: return breadthFirst(g);
+            case Strategy::Bisection:    return bisection(nodes);
+            default: {
+                std::vector<NodeId> order(g.numNodes());
+                std::iota(order.begin(), order.end(), 0u);
+                return order;
+            }
+        }
+    }
+
+    // Sorts nodes along a Hilbert curve over a 2^16 x 2^16 grid laid on
+    // their bounding box; ties keep their input order.
+    static std::vector<NodeId> hilbert(const std::vector<Node>& nodes){
+        std::vector<NodeId> order(nodes.size());
+        std::iota(order.begin(), order.end(), 0u);
+        if (nodes.empty()) return order;
+        float minX = nodes[0].x, maxX = minX, minY = nodes[0].y, maxY = minY;
+        for (const Node& v : nodes){
+            minX = std::min(minX, v.x); maxX = std::max(maxX, v.x);
+            minY = std::min(minY, v.y); maxY = std::max(maxY, v.y);
+        }
+        const double side = std::max({(double)maxX - minX, (double)maxY - minY, 1e-30});
+        const double scale = (kHilbertSide - 1) / side;
+        std::vector<uint64_t> key(nodes.size());
+        parallelFor(0, nodes.size(), [&](size_t i){
+            key[i] = hilbertIndex((uint32_t)std::lround((nodes[i].x - minX) * scale),
+                                  (uint32_t)std::lround((nodes[i].y - minY) * scale));
+        });
+        std::sort(order.begin(), order.end(), [&](NodeId a, NodeId b){
+            return key[a] < key[b] || (key[a] == key[b] && a < b);
+        });
+        return order;
+    }
+
+    // Breadth-first from a node at the edge of each component (the last node
+    // reached by a first sweep), neighbours in storage order; like
+    // Cuthill-McKee, this keeps the ids of adjacent nodes close without
+    // needing coordinates.
+    static std::vector<NodeId> breadthFirst(const CsrGraph& g){
+        const uint32_t n = g.numNodes();
+        std::vector<NodeId> order;
+        order.reserve(n);
+        std::vector<uint8_t> seen(n, 0);
+        std::vector<NodeId> sweep;
+        auto visit = [&](NodeId root, std::vector<NodeId>& out){
+            size_t head = out.size();
+            out.push_back(root); seen[root] = 1;
+            while (head < out.size()){
+                g.forEachArc(out[head++], [&](NodeId v, double){
+                    if (!seen[v]){ seen[v] = 1; out.push_back(v); }
+                });
+            }
+        };
+        for (NodeId s=0; s<n; ++s){
+            if (seen[s]) continue;
+            sweep.clear();
+            visit(s, sweep);
+            for (NodeId v : sweep) seen[v] = 0;
+            visit(sweep.back(), order);
+        }
+        return order;
+    }
+
+    // Recursive coordinate bisection: split at the median of the longer side
+    // until cells are small; cells that are close on the map end up close in
+    // the order.
+    static std::vector<NodeId> bisection(const std::vector<Node>& nodes){
+        std::vector<NodeId> order(nodes.size());
+        std::iota(order.begin(), order.end(), 0u);
+        std::vector<std::pair<size_t, size_t>> ranges{{0, order.size()}};
+        while (!ranges.empty()){
+            auto [lo, hi] = ranges.back(); ranges.pop_back();
+            if (hi - lo <= kLeafNodes) continue;
+            float minX = nodes[order[lo]].x, maxX = minX, minY = nodes[order[lo]].y, maxY = minY;
+            for (size_t i=lo; i<hi; ++i){
+                const Node& v = nodes[order[i]];
+                minX = std::min(minX, v.x); maxX = std::max(maxX, v.x);
+                minY = std::min(minY, v.y); maxY = std::max(maxY, v.y);
+            }
+            const bool alongX = maxX - minX >= maxY - minY;
+            const size_t mid = lo + (hi - lo) / 2;
+            std::nth_element(order.begin()+lo, order.begin()+mid, order.begin()+hi, [&](NodeId a, NodeId b){
+                return alongX ? nodes[a].x < nodes[b].x : nodes[a].y < nodes[b].y;
+            });
+            ranges.push_back({mid, hi});
+            ranges.push_back({lo, mid});
+        }
+        return order;
+    }
+
+    // Renumbers `nodes` and `g` so that order[i] becomes node i. `ids` maps
+    // every node to its id in the source data (empty: the current ids are
+    // those) and is permuted along. The rebuilt graph keeps current weights.
+    static void apply(const std::vector<NodeId>& order, std::vector<Node>& nodes, CsrGraph& g,
+                      std::vector<NodeId>& ids){
+        const uint32_t n = g.numNodes();
+        std::vector<NodeId> newId(n);
+        for (NodeId i=0; i<n; ++i) newId[order[i]] = i;
+
+        CsrGraph::Parts p;
+        p.offsets.assign(n + 1, 0);
+        for (NodeId i=0; i<n; ++i) p.offsets[i+1] = p.offsets[i] + (g.arcEnd(order[i]) - g.arcBegin(order[i]));
+        p.targets.resize(g.numArcs());
+        p.weights.resize(g.numArcs());
+        p.arcEdges.resize(g.numArcs());
+        parallelFor(0, n, [&](size_t i){
+            uint32_t out = p.offsets[i];
+            for (CsrGraph::ArcId a=g.arcBegin(order[i]); a<g.arcEnd(order[i]); ++a, ++out){
+                p.targets[out] = newId[g.arcTarget(a)];
+                p.weights[out] = g.arcWeight(a);
+                p.arcEdges[out] = g.arcEdge(a);
+            }
+        });
+        const uint32_t m = g.numEdges();
+        p.edgeEnds.resize(2*(size_t)m);
+        p.edgeSpeeds.resize(m);
+        p.edgeTolls.resize(m);
+        parallelFor(0, m, [&](size_t e){
+            p.edgeEnds[2*e]   = newId[g.edgeTail((CsrGraph::EdgeId)e)];
+            p.edgeEnds[2*e+1] = newId[g.edgeHead((CsrGraph::EdgeId)e)];
+            p.edgeSpeeds[e] = (float)g.edgeSpeed((CsrGraph::EdgeId)e);
+            p.edgeTolls[e]  = (float)g.edgeToll((CsrGraph::EdgeId)e);
+        });
+
+        std::vector<Node> permuted(n);
+        std::vector<NodeId> permutedIds(n);
+        for (NodeId i=0; i<n; ++i){
+            permuted[i] = std::move(nodes[order[i]]);
+            permutedIds[i] = ids.empty() ? order[i] : ids[order[i]];
+        }
+        nodes = std::move(permuted);
+        ids = std::move(permutedIds);
+        g = CsrGraph::fromParts(std::move(p));
+    }
+
+    // How far arcs jump in id space, as a stand-in for cache behaviour that
+    // is portable to measure: search labels are about 8 bytes per node.
+    struct Locality {
+        double meanGap = 0.0;  // mean log2(1 + |u - v|) over all arcs
+        double sameLine = 0.0; // share of arcs whose ends' labels share a 64-byte cache line
+        double samePage = 0.0; // ... a 4 KB page
+    };
+    static Locality measure(const CsrGraph& g){
+        Locality l;
+        if (g.numArcs() == 0) return l;
+        uint64_t line = 0, page = 0;
+        for (NodeId u=0; u<g.numNodes(); ++u){
+            g.forEachArc(u, [&](NodeId v, double){
+                l.meanGap += std::log2(1.0 + std::abs((double)u - (double)v));
+                line += (u >> 3) == (v >> 3);
+                page += (u >> 9) == (v >> 9);
+            });
+        }
+        l.meanGap /= g.numArcs();
+        l.sameLine = (double)line / g.numArcs();
+        l.samePage = (double)page / g.numArcs();
+        return l;
+    }
+
+private:
+    static constexpr uint32_t kHilbertSide = 1u << 16;
+    static constexpr uint32_t kLeafNodes = 16; // bisection stops below this
+
+    // Position of (x, y) along the Hilbert curve filling the kHilbertSide grid.
+    static uint64_t hilbertIndex(uint32_t x, uint32_t y){
+        uint64_t d = 0;
+        for (uint32_t s=kHilbertSide/2; s>0; s/=2){
+            const uint32_t rx = (x & s) ? 1 : 0, ry = (y & s) ? 1 : 0;
+            d += (uint64_t)s * s * ((3*rx) ^ ry);
+            if (ry == 0){
+                if (rx == 1){ x = kHilbertSide-1 - x; y = kHilbertSide-1 - y; }
+                std::swap(x, y);
+            }
+        }
+        return d;
+    }
+};
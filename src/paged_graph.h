@@ -0,0 +1,543 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <algorithm>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "graph.h"
+#include "node_order.h"
+#include "thread_pool.h"
+
+// ---------------- Out-of-core paged graph ----------------
+// Adjacency lists packed into fixed-size pages of a file and read through a
+// page cache with a fixed memory budget, for graphs whose arcs do not fit in
+// RAM. Nodes are ordered by recursive coordinate bisection before packing, so
+// a page holds one compact cell of the map and a search spreading through a
+// region keeps hitting the same few pages. When a page has to be read, the
+// cells it has most arcs into are prefetched on the shared pool.
+//
+// Node ids and forEachArc are those of the CsrGraph it was written from, so
+// the searches in dijkstra.h and bidirectional.h run on it unchanged. Only
+// per-node and per-page lookup tables stay in memory, next to the search
+// labels that are per node anyway. write() cuts the pages from a CsrGraph
+// in memory; reading needs nothing but the file. The header records the
+// fingerprint of the graph the pages match, so a file that is still current
+// is reopened instead of rewritten, and patchWeights() rewrites only the
+// pages whose weights changed.
+//
+// A page that is already resident is pinned without taking the cache lock:
+// frames carry atomic pin counts, and only filling a frame locks.
+class PagedGraph {
+public:
+    using NodeId = CsrGraph::NodeId;
+
+    // Page accesses; threadStats() counts those of the calling thread until
+    // the caller resets it, totals() those of every thread since open().
+    struct Stats {
+        uint64_t hits = 0;       // page was resident (or being prefetched); totals lag by a few per thread
+        uint64_t faults = 0;     // page had to be read before the search could go on
+        uint64_t prefetched = 0; // pages read ahead of time (totals only)
+        uint64_t errors = 0;     // page reads that failed; the search saw those nodes without arcs
+    };
+    static Stats& threadStats(){
+        thread_local Stats stats;
+        return stats;
+    }
+
+    PagedGraph() = default;
+    PagedGraph(const PagedGraph&) = delete;
+    PagedGraph& operator=(const PagedGraph&) = delete;
+    ~PagedGraph(){ close(); }
+
+    // ---- writing ----
+    // Cuts `g` into pages of `pageBytes` (a multiple of 64 that holds the
+    // largest node) in cell order; `nodes` gives the coordinates and
+    // externalIds (empty if the same) the ids the source data knows them by.
+    static bool write(const std::string& path, const CsrGraph& g, const std::vector<Node>& nodes,
+                      const std::vector<NodeId>& externalIds, uint32_t pageBytes, std::string& error){
+        const uint32_t n = g.numNodes();
+        if (nodes.size() != n || (!externalIds.empty() && externalIds.size() != n)){
+            error = path + ": node list does not match the graph";
+            return false;
+        }
+        if (pageBytes < 64 || pageBytes % 64 != 0){ error = path + ": page size must be a multiple of 64"; return false; }
+
+        // Pages: consecutive nodes of the cell order while they fit.
+        const std::vector<NodeId> order = NodeOrder::bisection(nodes);
+        std::vector<uint32_t> location(n), pageFirst{0};
+        uint32_t count = 0, arcs = 0;
+        for (uint32_t slot=0; slot<n; ++slot){
+            const NodeId u = order[slot];
+            const uint32_t degree = g.arcEnd(u) - g.arcBegin(u);
+            if (pageSize(1, degree) > pageBytes){
+                error = path + ": node " + std::to_string(u) + " has " + std::to_string(degree) + " arcs, more than a page holds";
+                return false;
+            }
+            if (pageSize(count + 1, arcs + degree) > pageBytes){ pageFirst.push_back(slot); count = arcs = 0; }
+            location[u] = slot;
+            ++count; arcs += degree;
+        }
+        pageFirst.push_back(n);
+        const uint32_t numPages = (uint32_t)pageFirst.size() - 1;
+        auto pageOfSlot = [&](uint32_t slot){
+            return (uint32_t)(std::upper_bound(pageFirst.begin(), pageFirst.end(), slot) - pageFirst.begin()) - 1;
+        };
+
+        // Neighbouring cells, most crossing arcs first.
+        std::vector<uint32_t> neighbourBegin{0}, neighbours;
+        std::vector<std::pair<uint32_t, uint32_t>> crossing; // (page, arcs)
+        for (uint32_t p=0; p<numPages; ++p){
+            crossing.clear();
+            for (uint32_t slot=pageFirst[p]; slot<pageFirst[p+1]; ++slot){
+                g.forEachArc(order[slot], [&](NodeId v, double){
+                    const uint32_t q = pageOfSlot(location[v]);
+                    if (q == p) return;
+                    auto it = std::find_if(crossing.begin(), crossing.end(), [&](const auto& c){ return c.first == q; });
+                    if (it == crossing.end()) crossing.push_back({q, 1}); else ++it->second;
+                });
+            }
+            std::sort(crossing.begin(), crossing.end(), [](const auto& a, const auto& b){
+                return a.second > b.second || (a.second == b.second && a.first < b.first);
+            });
+            for (const auto& c : crossing) neighbours.push_back(c.first);
+            neighbourBegin.push_back((uint32_t)neighbours.size());
+        }
+
+        Header h{};
+        h.magic = kMagic; h.version = kVersion; h.pageBytes = pageBytes;
+        h.numPages = numPages; h.numNodes = n; h.numNeighbours = (uint32_t)neighbours.size();
+        h.numArcs = g.numArcs();
+        h.fingerprint = g.fingerprint();
+        const uint64_t indexBytes = sizeof(Header) + 4ull*(2*(numPages + 1) + neighbours.size() + 2ull*n);
+        h.pagesOffset = (indexBytes + pageBytes - 1) / pageBytes * pageBytes;
+
+        std::ofstream out(path, std::ios::binary);
+        if (!out){ error = path + ": cannot write"; return false; }
+        out.write((const char*)&h, sizeof(h));
+        out.write((const char*)pageFirst.data(), pageFirst.size()*4);
+        out.write((const char*)neighbourBegin.data(), neighbourBegin.size()*4);
+        out.write((const char*)neighbours.data(), neighbours.size()*4);
+        out.write((const char*)location.data(), location.size()*4);
+        std::vector<NodeId> ids = externalIds;
+        if (ids.empty()) for (NodeId v=0; v<n; ++v) ids.push_back(v);
+        out.write((const char*)ids.data(), ids.size()*4);
+        out.write(std::vector<char>(h.pagesOffset - indexBytes, 0).data(), (std::streamsize)(h.pagesOffset - indexBytes));
+
+        // Page: {first slot, node count}, arc offsets per node, targets,
+        // then the weights 8-byte aligned.
+        std::vector<char> page(pageBytes);
+        for (uint32_t p=0; p<numPages; ++p){
+            std::fill(page.begin(), page.end(), 0);
+            const uint32_t first = pageFirst[p], nodesHere = pageFirst[p+1] - first;
+            uint32_t arcsHere = 0;
+            for (uint32_t slot=first; slot<pageFirst[p+1]; ++slot) arcsHere += g.arcEnd(order[slot]) - g.arcBegin(order[slot]);
+            uint32_t* header = (uint32_t*)page.data();
+            header[0] = first; header[1] = nodesHere;
+            uint32_t* arcBegin = header + 2;
+            uint32_t* targets = arcBegin + nodesHere + 1;
+            double* weights = (double*)(page.data() + weightsAt(nodesHere, arcsHere));
+            uint32_t a = 0;
+            for (uint32_t i=0; i<nodesHere; ++i){
+                arcBegin[i] = a;
+                g.forEachArc(order[first + i], [&](NodeId v, double w){ targets[a] = v; weights[a] = w; ++a; });
+            }
+            arcBegin[nodesHere] = a;
+            out.write(page.data(), pageBytes);
+        }
+        if (!out){ error = path + ": write failed"; return false; }
+        return true;
+    }
+
+    // Rewrites the weights of every node in `changed` from `g`, which must be
+    // the graph the file was written from with only weights changed. Only the
+    // pages holding those nodes are read and written; the file is marked
+    // edited, since it no longer matches the network it was cut from. The
+    // file must not be open for reading meanwhile.
+    static bool patchWeights(const std::string& path, const CsrGraph& g, const std::vector<NodeId>& changed, std::string& error){
+        auto fail = [&](const std::string& problem){ error = path + ": " + problem; return false; };
+        std::fstream io(path, std::ios::binary | std::ios::in | std::ios::out);
+        Header h;
+        if (!io || !io.read((char*)&h, sizeof(h))) return fail("cannot open for patching");
+        if (h.magic != kMagic || h.version != kVersion || h.numNodes != g.numNodes() || h.numArcs != g.numArcs())
+            return fail("not written from this graph");
+        std::vector<uint32_t> pageFirst((size_t)h.numPages + 1), location(h.numNodes);
+        const uint64_t locationAt = sizeof(Header) + 4ull*(2*(h.numPages + 1) + h.numNeighbours);
+        if (!io.read((char*)pageFirst.data(), pageFirst.size()*4) ||
+            !io.seekg((std::streamoff)locationAt) || !io.read((char*)location.data(), location.size()*4))
+            return fail("truncated index");
+
+        std::vector<uint32_t> pages;
+        for (NodeId u : changed){
+            if (u >= h.numNodes || location[u] >= h.numNodes) return fail("bad index");
+            pages.push_back((uint32_t)(std::upper_bound(pageFirst.begin(), pageFirst.end(), location[u]) - pageFirst.begin()) - 1);
+        }
+        std::sort(pages.begin(), pages.end());
+        pages.erase(std::unique(pages.begin(), pages.end()), pages.end());
+        std::vector<NodeId> order(h.numNodes); // node in each slot
+        for (NodeId v=0; v<h.numNodes; ++v) order[location[v]] = v;
+
+        std::vector<char> page(h.pageBytes);
+        for (uint32_t p : pages){
+            const std::streamoff at = (std::streamoff)(h.pagesOffset + (uint64_t)p * h.pageBytes);
+            if (!io.seekg(at) || !io.read(page.data(), h.pageBytes)) return fail("truncated page");
+            const uint32_t* header = (const uint32_t*)page.data();
+            const uint32_t first = header[0], count = header[1];
+            const uint32_t* arcBegin = header + 2;
+            if (first != pageFirst[p] || count != pageFirst[p+1] - first) return fail("bad page " + std::to_string(p));
+            double* weights = (double*)(page.data() + weightsAt(count, arcBegin[count]));
+            for (uint32_t i=0; i<count; ++i){
+                const NodeId u = order[first + i];
+                if (arcBegin[i+1] - arcBegin[i] != g.arcEnd(u) - g.arcBegin(u)) return fail("not written from this graph");
+                uint32_t a = arcBegin[i];
+                g.forEachArc(u, [&](NodeId, double w){ weights[a++] = w; });
+            }
+            if (!io.seekp(at) || !io.write(page.data(), h.pageBytes)) return fail("write failed");
+        }
+        h.fingerprint = g.fingerprint();
+        h.edited = 1;
+        if (!io.seekp(0) || !io.write((const char*)&h, sizeof(h)) || !io.flush()) return fail("write failed");
+        return true;
+    }
+
+    // ---- reading ----
+    // Reads the lookup tables; pages are read on demand into at most
+    // `cacheBytes` of frames (never fewer than the pool can pin at once).
+    bool open(const std::string& path, size_t cacheBytes, std::string& error, bool prefetch = true){
+        close();
+        auto fail = [&](const std::string& problem){ error = path + ": " + problem; file.close(); return false; };
+        if (!file.open(path)) return fail("cannot open");
+        Header h;
+        if (!file.readAt(0, &h, sizeof(h))) return fail("too short for a paged graph");
+        if (h.magic != kMagic) return fail("not a paged graph");
+        if (h.version != kVersion) return fail("format version " + std::to_string(h.version) + ", expected " + std::to_string(kVersion));
+        if (h.pageBytes < 64 || h.pageBytes % 64 != 0 || h.numNodes >= CsrGraph::kInvalid) return fail("bad header");
+
+        pageFirst.resize((size_t)h.numPages + 1);
+        neighbourBegin.resize((size_t)h.numPages + 1);
+        neighbours.resize(h.numNeighbours);
+        location.resize(h.numNodes);
+        externalIds.resize(h.numNodes);
+        uint64_t at = sizeof(Header);
+        for (auto* table : {&pageFirst, &neighbourBegin, &neighbours, &location, &externalIds}){
+            if (!file.readAt(at, table->data(), table->size()*4)) return fail("truncated index");
+            at += table->size()*4;
+        }
+        if (pageFirst.front() != 0 || pageFirst.back() != h.numNodes || !std::is_sorted(pageFirst.begin(), pageFirst.end()) ||
+            neighbourBegin.back() != h.numNeighbours || !std::is_sorted(neighbourBegin.begin(), neighbourBegin.end()) ||
+            std::any_of(neighbours.begin(), neighbours.end(), [&](uint32_t q){ return q >= h.numPages; }) ||
+            std::any_of(location.begin(), location.end(), [&](uint32_t s){ return s >= h.numNodes; }) ||
+            h.pagesOffset < at) return fail("bad index");
+
+        bytesPerPage = h.pageBytes;
+        pagesOffset = h.pagesOffset;
+        arcCount = h.numArcs;
+        sourceFingerprint = h.fingerprint;
+        weightsEdited = h.edited != 0;
+        const size_t minFrames = (size_t)sharedPool().size() + 2;
+        const size_t numFrames = std::min<size_t>(std::max(cacheBytes / bytesPerPage, minFrames), std::max<size_t>(h.numPages, 1));
+        frames = std::vector<Frame>(numFrames);
+        buffer.assign(numFrames * bytesPerPage / sizeof(uint64_t), 0);
+        frameOfPage = std::vector<std::atomic<uint32_t>>(h.numPages);
+        for (auto& f : frameOfPage) f.store(kNone, std::memory_order_relaxed);
+        hand = 0;
+        prefetching = prefetch;
+        totalHits = totalFaults = totalPrefetched = totalErrors = 0;
+        return true;
+    }
+
+    // Waits for outstanding prefetches, then drops the cache.
+    void close(){
+        while (inflight.load() > 0) if (!sharedPool().runPendingTask()) std::this_thread::yield();
+        file.close();
+        frames.clear(); buffer.clear(); buffer.shrink_to_fit(); frameOfPage.clear();
+        pageFirst.clear(); neighbourBegin.clear(); neighbours.clear(); location.clear(); externalIds.clear();
+    }
+
+    bool isOpen() const { return file.isOpen(); }
+    uint32_t numNodes() const { return (uint32_t)location.size(); }
+    uint64_t numArcs() const { return arcCount; }
+    uint32_t numPages() const { return (uint32_t)frameOfPage.size(); }
+    uint32_t pageBytes() const { return bytesPerPage; }
+    size_t cacheBytes() const { return frames.size() * bytesPerPage; }
+    uint64_t fingerprint() const { return sourceFingerprint; } // of the graph the pages match
+    bool edited() const { return weightsEdited; }              // patched since written
+    NodeId externalId(NodeId u) const { return externalIds[u]; }
+    Stats totals() const { return {totalHits.load(), totalFaults.load(), totalPrefetched.load(), totalErrors.load()}; }
+
+    // f(target, weight) for every arc leaving u, as CsrGraph::forEachArc. The
+    // page stays pinned while f runs; f must not call back into the graph. If
+    // the page cannot be read, u has no arcs for this call and the failure is
+    // counted in `errors`, so the caller can tell the answer is incomplete;
+    // the page is read again on next access.
+    template<class F> void forEachArc(NodeId u, F&& f) const {
+        const uint32_t slot = location[u];
+        const uint32_t page = (uint32_t)(std::upper_bound(pageFirst.begin(), pageFirst.end(), slot) - pageFirst.begin()) - 1;
+        const uint32_t frame = acquire(page);
+        if (frame == kNone){
+            ++threadStats().errors;
+            totalErrors.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        const char* data = frameData(frame);
+        const uint32_t* header = (const uint32_t*)data;
+        const uint32_t count = header[1], i = slot - header[0];
+        const uint32_t* arcBegin = header + 2;
+        const uint32_t* targets = arcBegin + count + 1;
+        const double* weights = (const double*)(data + weightsAt(count, arcBegin[count]));
+        for (uint32_t a=arcBegin[i]; a<arcBegin[i+1]; ++a) f(targets[a], weights[a]);
+        release(frame);
+    }
+
+private:
+    static constexpr uint32_t kMagic = 0x47505650; // "PVPG"
+    static constexpr uint32_t kVersion = 2;
+    static constexpr uint32_t kNone = ~0u;
+    static constexpr uint32_t kMaxPrefetch = 4;   // neighbouring cells read ahead per fault
+    static constexpr uint32_t kClaimed = 1u << 30; // pin count of a frame being refilled
+    static constexpr uint32_t kHitBatch = 64;      // hits counted per thread before totals see them
+
+    struct Header {
+        uint32_t magic, version, pageBytes, numPages;
+        uint32_t numNodes, numNeighbours;
+        uint64_t numArcs, pagesOffset;
+        uint64_t fingerprint;     // CsrGraph::fingerprint() of the graph the pages match
+        uint32_t edited, reserved; // edited: weights patched since write()
+    };
+
+    // Positional reads that several threads may issue at once.
+    class File {
+    public:
+        bool open(const std::string& path){
+            close();
+#ifdef _WIN32
+            handle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, nullptr);
+            return handle != INVALID_HANDLE_VALUE;
+#else
+            fd = ::open(path.c_str(), O_RDONLY);
+            return fd >= 0;
+#endif
+        }
+        void close(){
+#ifdef _WIN32
+            if (handle != INVALID_HANDLE_VALUE) CloseHandle(handle);
+            handle = INVALID_HANDLE_VALUE;
+#else
+            if (fd >= 0) ::close(fd);
+            fd = -1;
+#endif
+        }
+        bool isOpen() const {
+#ifdef _WIN32
+            return handle != INVALID_HANDLE_VALUE;
+#else
+            return fd >= 0;
+#endif
+        }
+        bool readAt(uint64_t offset, void* dst, size_t bytes) const {
+            char* p = (char*)dst;
+            while (bytes > 0){
+#ifdef _WIN32
+                OVERLAPPED at{};
+                at.Offset = (DWORD)offset; at.OffsetHigh = (DWORD)(offset >> 32);
+                DWORD got = 0;
+                if (!ReadFile(handle, p, (DWORD)std::min<size_t>(bytes, 1u << 30), &got, &at) || got == 0) return false;
+#else
+                ssize_t got = pread(fd, p, bytes, (off_t)offset);
+                if (got <= 0) return false;
+#endif
+                p += got; offset += (uint64_t)got; bytes -= (size_t)got;
+            }
+            return true;
+        }
+        ~File(){ close(); }
+
+    private:
+#ifdef _WIN32
+        HANDLE handle = INVALID_HANDLE_VALUE;
+#else
+        int fd = -1;
+#endif
+    };
+
+    // A reader pins a frame by incrementing `pins`; refilling claims it by
+    // swapping pins from 0 to kClaimed, so a pin that lands meanwhile sees a
+    // count of kClaimed or more and backs off. page, ready and ok only change
+    // while the frame is claimed or pinned by its read.
+    struct Frame {
+        std::atomic<uint32_t> page{kNone};
+        std::atomic<uint32_t> pins{0};          // searches reading it, plus its own read
+        std::atomic<bool> referenced{false};    // CLOCK second chance
+        std::atomic<bool> ready{false};
+        bool ok = true;                         // the read succeeded; set before ready
+    };
+
+    static uint32_t weightsAt(uint32_t count, uint32_t arcs){ return (4*(2 + count + 1 + arcs) + 7) / 8 * 8; }
+    static uint64_t pageSize(uint32_t count, uint32_t arcs){ return (uint64_t)weightsAt(count, arcs) + 8ull*arcs; }
+
+    const char* frameData(uint32_t f) const { return (const char*)buffer.data() + (size_t)f * bytesPerPage; }
+
+    // Claims an unpinned frame to refill (CLOCK), or returns kNone if every
+    // frame is pinned. Lock held.
+    uint32_t victim() const {
+        for (size_t step=0; step<2*frames.size(); ++step){
+            const uint32_t f = hand;
+            hand = (hand + 1) % (uint32_t)frames.size();
+            Frame& fr = frames[f];
+            if (fr.pins.load() > 0) continue;
+            if (fr.page.load() != kNone && fr.referenced.exchange(false)) continue;
+            uint32_t unpinned = 0;
+            if (fr.pins.compare_exchange_strong(unpinned, kClaimed)) return f;
+        }
+        return kNone;
+    }
+
+    // Reads `page` into the claimed frame f, dropping the lock meanwhile. The
+    // frame stays pinned for a demand read and is released for a prefetch. A
+    // failed read leaves the frame empty, so the page is not cached.
+    bool load(uint32_t f, uint32_t page, bool demand, std::unique_lock<std::mutex>& lk) const {
+        Frame& fr = frames[f];
+        const uint32_t old = fr.page.load();
+        if (old != kNone) frameOfPage[old].store(kNone);
+        fr.ready.store(false);
+        fr.referenced.store(demand);
+        fr.page.store(page);
+        frameOfPage[page].store(f);
+        fr.pins.fetch_sub(kClaimed - 1); // claimed -> pinned once, by this read
+        lk.unlock();
+        const bool ok = file.readAt(pagesOffset + (uint64_t)page * bytesPerPage, (void*)frameData(f), bytesPerPage);
+        lk.lock();
+        fr.ok = ok;
+        if (!ok){ frameOfPage[page].store(kNone); fr.page.store(kNone); }
+        fr.ready.store(true);
+        if (!demand) fr.pins.fetch_sub(1);
+        if (waiters.load() > 0) changed.notify_all();
+        return ok;
+    }
+
+    // Pins the frame holding `page`, reading the page if it is not resident;
+    // kNone if the read failed. A resident, ready page costs two atomic
+    // operations and no lock.
+    uint32_t acquire(uint32_t page) const {
+        Stats& stats = threadStats();
+        const uint32_t f = frameOfPage[page].load();
+        if (f != kNone){
+            Frame& fr = frames[f];
+            // ready before page: a failed read clears page before it sets ready
+            if (fr.pins.fetch_add(1) < kClaimed && fr.ready.load() && fr.page.load() == page){
+                if (!fr.referenced.load(std::memory_order_relaxed)) fr.referenced.store(true, std::memory_order_relaxed);
+                countHit(stats);
+                return f;
+            }
+            release(f);
+        }
+
+        // Missing, being read or being refilled: settle it under the lock,
+        // where no frame is claimed and frameOfPage agrees with the frames.
+        std::unique_lock<std::mutex> lk(lock);
+        for (;;){
+            uint32_t g = frameOfPage[page].load();
+            if (g != kNone){
+                Frame& fr = frames[g];
+                fr.pins.fetch_add(1); fr.referenced.store(true);
+                if (!fr.ready.load()){ ++waiters; changed.wait(lk, [&]{ return fr.ready.load(); }); --waiters; }
+                if (!fr.ok){
+                    fr.pins.fetch_sub(1);
+                    if (waiters.load() > 0) changed.notify_all();
+                    return kNone;
+                }
+                countHit(stats);
+                return g;
+            }
+            ++waiters; // before scanning, so an unpin after the scan wakes us
+            g = victim();
+            if (g == kNone){ changed.wait(lk); --waiters; continue; }
+            --waiters;
+            ++stats.faults; ++totalFaults;
+            if (!load(g, page, true, lk)){
+                frames[g].pins.fetch_sub(1);
+                if (waiters.load() > 0) changed.notify_all();
+                return kNone;
+            }
+            lk.unlock();
+            prefetchAround(page);
+            return g;
+        }
+    }
+
+    // Hits go to totals in batches of kHitBatch per thread, so a search does
+    // not write a shared counter on every node; totals() may lag by that.
+    void countHit(Stats& stats) const {
+        ++stats.hits;
+        thread_local uint32_t unflushed = 0;
+        if (++unflushed == kHitBatch){ totalHits.fetch_add(kHitBatch, std::memory_order_relaxed); unflushed = 0; }
+    }
+
+    // Unpins without the lock; only a last unpin with someone waiting for a
+    // free frame takes it, to wake them.
+    void release(uint32_t f) const {
+        if (frames[f].pins.fetch_sub(1) == 1 && waiters.load() > 0){
+            std::lock_guard<std::mutex> lk(lock);
+            changed.notify_all();
+        }
+    }
+
+    // Queues reads of the cells `page` shares most arcs with.
+    void prefetchAround(uint32_t page) const {
+        if (!prefetching) return;
+        const uint32_t end = std::min(neighbourBegin[page+1], neighbourBegin[page] + kMaxPrefetch);
+        for (uint32_t i=neighbourBegin[page]; i<end; ++i){
+            const uint32_t q = neighbours[i];
+            if (frameOfPage[q].load() != kNone) continue;
+            inflight.fetch_add(1);
+            sharedPool().post([this, q]{
+                {
+                    std::unique_lock<std::mutex> lk(lock);
+                    const uint32_t f = frameOfPage[q].load() == kNone ? victim() : kNone;
+                    if (f != kNone && load(f, q, false, lk)) ++totalPrefetched;
+                }
+                inflight.fetch_sub(1);
+            });
+        }
+    }
+
+    File file;
+    uint32_t bytesPerPage = 0;
+    uint64_t pagesOffset = 0, arcCount = 0, sourceFingerprint = 0;
+    bool prefetching = true, weightsEdited = false;
+    std::vector<uint32_t> pageFirst;       // first slot of each page, numPages+1
+    std::vector<uint32_t> neighbourBegin;  // neighbouring cells of page p: neighbours[begin[p], begin[p+1])
+    std::vector<uint32_t> neighbours;
+    std::vector<uint32_t> location;        // slot of each node in the cell order
+    std::vector<uint32_t> externalIds;     // id of each node in the source data
+
+    // Cache state. Filling a frame and the CLOCK hand are guarded by `lock`;
+    // pins and lookups of resident pages are atomic and lock-free.
+    mutable std::mutex lock;
+    mutable std::condition_variable changed; // a read finished or a frame was unpinned
+    mutable std::vector<Frame> frames;
+    mutable std::vector<uint64_t> buffer;    // frames' pages, 8-byte aligned
+    mutable std::vector<std::atomic<uint32_t>> frameOfPage;
+    mutable uint32_t hand = 0;
+    mutable std::atomic<uint32_t> waiters{0};
+    mutable std::atomic<uint32_t> inflight{0};
+    mutable std::atomic<uint64_t> totalHits{0}, totalFaults{0}, totalPrefetched{0}, totalErrors{0};
+};
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstddef>
+#include <utility>
+
+#include "thread_pool.h"
+
+// ---------------- Parallel loops ----------------
+// Calls f(i) for every index of [begin, end) on the shared work-stealing
+// pool. Ranges below `grain` run inline on the caller, so tiny loops (and
+// single-core machines) pay no scheduling cost. Loops may nest: the caller
+// works through the loop's chunks itself instead of waiting on the queues.
+template<class F>
+void parallelFor(size_t begin, size_t end, F&& f, size_t grain = 1024){
+    sharedPool().parallelFor(begin, end, std::forward<F>(f), grain);
+}
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <vector>
+#include <array>
+#include <cstdint>
+#include <algorithm>
+#include <functional>
+
+#include "graph.h"
+
+// ---------------- Multi-criteria (Pareto) routing ----------------
+// Label-setting search over several per-edge criteria at once. A node keeps
+// a bag of labels (cost vectors) none of which dominates another; labels
+// leave the heap in lexicographic order, so a popped label is final. The
+// result is every non-dominated s-t route, e.g. the shortest, the fastest,
+// the cheapest and the compromises between them.
+//
+// With epsilon > 0 a new label is also dropped when an existing one is within
+// a factor (1 + epsilon) of it on every criterion, which bounds the number of
+// labels at the price of missing routes that are barely better than a kept one.
+struct ParetoOptions {
+    double   epsilon   = 0.0;
+    uint32_t maxLabels = 1u << 20; // search stops creating labels beyond this
+};
+
+class ParetoRouter {
+public:
+    static constexpr uint32_t kCriteria = 3;
+    using Costs = std::array<double, kCriteria>;
+    using EdgeWeights = std::array<const std::vector<double>*, kCriteria>; // per EdgeId, one per criterion
+
+    struct Route {
+        std::vector<int> path;
+        Costs costs{};
+    };
+    using Options = ParetoOptions;
+
+    // Non-dominated routes ordered by the first criterion.
+    std::vector<Route> search(const CsrGraph& g, const EdgeWeights& weights, int source, int target,
+                              const Options& options = Options()){
+        pool.clear();
+        heap.clear();
+        truncatedLast = false;
+        if (++generation == 0){ std::fill(stamps.begin(), stamps.end(), 0u); generation = 1; }
+        if (stamps.size() < g.numNodes()){ stamps.resize(g.numNodes(), 0); bags.resize(g.numNodes()); }
+
+        addLabel((uint32_t)source, Costs{}, kNone, options.epsilon);
+        while (!heap.empty()){
+            std::pop_heap(heap.begin(), heap.end(), std::greater<>());
+            const uint32_t id = heap.back().second; heap.pop_back();
+            if (!pool[id].alive) continue;
+            const Label label = pool[id];
+            if (label.node == (uint32_t)target) continue; // routes do not pass through the target
+            if (coveredBy(bag((uint32_t)target), label.costs, options.epsilon)) continue; // cannot lead anywhere new
+
+            for (auto a=g.arcBegin(label.node); a<g.arcEnd(label.node); ++a){
+                const CsrGraph::EdgeId e = g.arcEdge(a);
+                Costs c = label.costs;
+                for (uint32_t i=0; i<kCriteria; ++i) c[i] += (*weights[i])[e];
+                if (pool.size() >= options.maxLabels){ truncatedLast = true; break; }
+                addLabel(g.arcTarget(a), c, id, options.epsilon);
+            }
+        }
+
+        std::vector<Route> routes;
+        for (uint32_t id : bag((uint32_t)target)){
+            Route r;
+            r.costs = pool[id].costs;
+            for (uint32_t cur=id; cur!=kNone; cur=pool[cur].pred) r.path.push_back((int)pool[cur].node);
+            std::reverse(r.path.begin(), r.path.end());
+            routes.push_back(std::move(r));
+        }
+        std::sort(routes.begin(), routes.end(), [](const Route& a, const Route& b){ return a.costs < b.costs; });
+        return routes;
+    }
+
+    uint32_t labelsCreated() const { return (uint32_t)pool.size(); }
+    bool truncated() const { return truncatedLast; } // last search hit maxLabels
+
+private:
+    static constexpr uint32_t kNone = ~0u;
+
+    struct Label {
+        Costs costs;
+        uint32_t node;
+        uint32_t pred;  // label it was extended from
+        bool alive;     // false once a better label at the node replaced it
+    };
+
+    // a is no worse than b (scaled by 1 + epsilon) on every criterion
+    static bool dominates(const Costs& a, const Costs& b, double epsilon){
+        const double f = 1.0 + epsilon;
+        for (uint32_t i=0; i<kCriteria; ++i) if (a[i] > b[i]*f) return false;
+        return true;
+    }
+
+    bool coveredBy(const std::vector<uint32_t>& labels, const Costs& c, double epsilon) const {
+        for (uint32_t id : labels) if (dominates(pool[id].costs, c, epsilon)) return true;
+        return false;
+    }
+
+    std::vector<uint32_t>& bag(uint32_t v){
+        if (stamps[v] != generation){ bags[v].clear(); stamps[v] = generation; }
+        return bags[v];
+    }
+
+    // Inserts unless dominated; evicts the bag entries the new label dominates.
+    // Popped labels are lexicographically smaller than anything created later,
+    // so only labels still in the heap can be evicted.
+    void addLabel(uint32_t v, const Costs& c, uint32_t pred, double epsilon){
+        auto& b = bag(v);
+        if (coveredBy(b, c, epsilon)) return;
+        b.erase(std::remove_if(b.begin(), b.end(), [&](uint32_t id){
+            if (!dominates(c, pool[id].costs, 0.0)) return false;
+            pool[id].alive = false;
+            return true;
+        }), b.end());
+        const uint32_t id = (uint32_t)pool.size();
+        pool.push_back({c, v, pred, true});
+        b.push_back(id);
+        heap.push_back({c, id});
+        std::push_heap(heap.begin(), heap.end(), std::greater<>());
+    }
+
+    // Kept between searches so their capacity is reused.
+    std::vector<Label> pool;
+    std::vector<std::vector<uint32_t>> bags; // label ids per node, valid when stamps[v] == generation
+    std::vector<uint32_t> stamps;
+    uint32_t generation = 0;
+    std::vector<std::pair<Costs, uint32_t>> heap;
+    bool truncatedLast = false;
+};
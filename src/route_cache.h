@@ -0,0 +1,144 @@
+#pragma once
+
+#include <vector>
+#include <list>
+#include <unordered_map>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+#include <algorithm>
+
+// ---------------- Route cache ----------------
+// Remembers finished routes keyed by (source, target, metric). The key space
+// is split over independent shards, each an LRU list plus a hash index under
+// its own mutex, so concurrent callers rarely contend. Every shard gets an
+// equal share of the byte budget and evicts from its cold end.
+//
+// Entries are tagged with the graph version they were computed on. A shard
+// that sees a different version drops everything it holds first, so a weight
+// change invalidates the cache without a global sweep.
+class RouteCache {
+public:
+    struct Stats {
+        uint64_t hits = 0, misses = 0, evictions = 0, invalidations = 0;
+    };
+
+    explicit RouteCache(size_t budgetBytes, uint32_t numShards = 16)
+        : shards(std::max(1u, numShards)), shardBudget(budgetBytes / std::max(1u, numShards)) {}
+
+    RouteCache(const RouteCache&) = delete;
+    RouteCache& operator=(const RouteCache&) = delete;
+
+    // Copies the cached route into path/distance; false on a miss.
+    bool lookup(uint32_t source, uint32_t target, uint32_t metric, uint64_t graphVersion,
+                std::vector<int>& path, double& distance){
+        const Key key{source, target, metric};
+        Shard& sh = shardOf(key);
+        std::lock_guard<std::mutex> lock(sh.mutex);
+        syncVersion(sh, graphVersion);
+        auto it = sh.index.find(key);
+        if (it == sh.index.end()){ ++misses; return false; }
+        sh.lru.splice(sh.lru.begin(), sh.lru, it->second); // now most recent
+        const Entry& e = *it->second;
+        path.assign(e.path.begin(), e.path.end());
+        distance = e.distance;
+        ++hits;
+        return true;
+    }
+
+    void insert(uint32_t source, uint32_t target, uint32_t metric, uint64_t graphVersion,
+                const std::vector<int>& path, double distance){
+        const Key key{source, target, metric};
+        Shard& sh = shardOf(key);
+        std::lock_guard<std::mutex> lock(sh.mutex);
+        syncVersion(sh, graphVersion);
+        auto found = sh.index.find(key);
+        if (found != sh.index.end()) erase(sh, found->second);
+
+        Entry e{key, std::vector<uint32_t>(path.begin(), path.end()), distance};
+        const size_t bytes = entryBytes(e);
+        if (bytes > shardBudget) return; // would evict the whole shard and still not fit
+        sh.lru.push_front(std::move(e));
+        sh.index[key] = sh.lru.begin();
+        sh.bytes += bytes;
+        while (sh.bytes > shardBudget){
+            erase(sh, std::prev(sh.lru.end()));
+            ++evictions;
+        }
+    }
+
+    void clear(){
+        for (auto& sh : shards){
+            std::lock_guard<std::mutex> lock(sh.mutex);
+            sh.lru.clear(); sh.index.clear(); sh.bytes = 0;
+        }
+    }
+
+    Stats stats() const {
+        Stats s;
+        s.hits = hits; s.misses = misses; s.evictions = evictions; s.invalidations = invalidations;
+        return s;
+    }
+
+    size_t sizeBytes() const {
+        size_t total = 0;
+        for (auto& sh : shards){
+            std::lock_guard<std::mutex> lock(sh.mutex);
+            total += sh.bytes;
+        }
+        return total;
+    }
+
+private:
+    struct Key {
+        uint32_t source, target, metric;
+        bool operator==(const Key& o) const { return source==o.source && target==o.target && metric==o.metric; }
+    };
+    struct KeyHash {
+        size_t operator()(const Key& k) const {
+            uint64_t h = ((uint64_t)k.source << 32 | k.target) * 0x9E3779B97F4A7C15ull;
+            h ^= (uint64_t)k.metric * 0xC2B2AE3D27D4EB4Full;
+            return (size_t)(h ^ (h >> 29));
+        }
+    };
+    struct Entry {
+        Key key;
+        std::vector<uint32_t> path; // node ids, 4 bytes each
+        double distance;
+    };
+    using Lru = std::list<Entry>;
+
+    struct Shard {
+        mutable std::mutex mutex;
+        Lru lru; // front = most recently used
+        std::unordered_map<Key, Lru::iterator, KeyHash> index;
+        size_t bytes = 0;
+        uint64_t version = 0;
+    };
+
+    // Node, hash bucket and path storage; an estimate, not allocator-exact.
+    static size_t entryBytes(const Entry& e){
+        return sizeof(Entry) + 2*sizeof(void*)                     // list node
+             + sizeof(Key) + sizeof(Lru::iterator) + 2*sizeof(void*) // map node + bucket
+             + e.path.capacity()*sizeof(uint32_t);
+    }
+
+    Shard& shardOf(const Key& k){ return shards[KeyHash{}(k) % shards.size()]; }
+
+    void syncVersion(Shard& sh, uint64_t graphVersion){
+        if (sh.version == graphVersion) return;
+        if (!sh.lru.empty()) ++invalidations;
+        sh.lru.clear(); sh.index.clear(); sh.bytes = 0;
+        sh.version = graphVersion;
+    }
+
+    void erase(Shard& sh, Lru::iterator it){
+        sh.bytes -= entryBytes(*it);
+        sh.index.erase(it->key);
+        sh.lru.erase(it);
+    }
+
+    std::vector<Shard> shards;
+    const size_t shardBudget;
+    std::atomic<uint64_t> hits{0}, misses{0}, evictions{0}, invalidations{0};
+};
@@ -0,0 +1,217 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <future>
+#include <functional>
+#include <type_traits>
+#include <algorithm>
+#include <cstddef>
+
+// ---------------- Work-stealing thread pool ----------------
+// Each worker owns a deque: it pushes and pops its own tasks at the back and,
+// when that runs dry, steals from the front of the others. Tasks submitted
+// from outside are dealt round-robin over the deques. Every deque has its own
+// lock, so there is no lock shared by all workers on the hot path; the only
+// common mutex guards going to sleep when there is nothing left anywhere.
+//
+// parallelFor() callers claim the loop's chunks themselves, so a loop
+// finishes even when every worker is busy and nested loops cannot deadlock.
+// While the last chunks run elsewhere, a waiting worker runs other queued
+// tasks; any other thread (the UI) only waits for its own loop, so a batch
+// in the queues cannot stall it. Blocking on a future from inside a task can
+// deadlock, if every worker does it at once.
+class ThreadPool {
+public:
+    explicit ThreadPool(unsigned workers = std::max(1u, std::thread::hardware_concurrency())){
+        for (unsigned i=0; i<workers; ++i) queues.emplace_back(new Queue);
+        for (unsigned i=0; i<workers; ++i) threads.emplace_back([this, i]{ workerLoop(i); });
+    }
+    ~ThreadPool(){
+        {
+            std::lock_guard<std::mutex> lk(sleepLock);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto& t : threads) t.join();
+    }
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    unsigned size() const { return (unsigned)threads.size(); }
+
+    // Fire and forget.
+    void post(std::function<void()> task){
+        const size_t q = currentPool == this ? currentWorker : nextQueue.fetch_add(1, std::memory_order_relaxed) % queues.size();
+        {
+            std::lock_guard<std::mutex> lk(queues[q]->lock);
+            queues[q]->tasks.push_back(std::move(task));
+        }
+        queued.fetch_add(1);
+        if (sleepers.load() > 0){
+            std::lock_guard<std::mutex> lk(sleepLock);
+            wake.notify_one();
+        }
+    }
+
+    // f() on a worker; the future carries its result.
+    template<class F>
+    auto submit(F&& f) -> std::future<std::invoke_result_t<F>> {
+        using R = std::invoke_result_t<F>;
+        auto task = std::make_shared<std::packaged_task<R()>>(std::forward<F>(f));
+        std::future<R> result = task->get_future();
+        post([task]{ (*task)(); });
+        return result;
+    }
+
+    // Runs one queued task on the calling thread, if there is one.
+    bool runPendingTask(){
+        std::function<void()> task;
+        if (!take(task)) return false;
+        task();
+        return true;
+    }
+
+    // f(i) for every i in [begin, end). The range is cut into a few chunks per
+    // worker so fast threads can steal from slow ones. Workers and the caller
+    // claim chunks from one counter; helper tasks that only get to run after
+    // the loop is over find nothing left and return. Ranges below `grain` (or
+    // a one-thread pool) run inline.
+    template<class F>
+    void parallelFor(size_t begin, size_t end, F&& f, size_t grain = 1024){
+        const size_t count = end > begin ? end - begin : 0;
+        size_t chunks = std::min<size_t>((count + grain - 1) / std::max<size_t>(grain, 1), (size_t)size() * 4);
+        if (size() <= 1 || chunks <= 1){
+            for (size_t i=begin; i<end; ++i) f(i);
+            return;
+        }
+        const size_t chunk = (count + chunks - 1) / chunks;
+        chunks = (count + chunk - 1) / chunk;
+        struct Loop {
+            std::atomic<size_t> next{0}; // chunks claimed
+            std::atomic<size_t> done{0}; // chunks finished
+        };
+        auto loop = std::make_shared<Loop>();
+        // f is only touched for a claimed chunk, and the caller does not
+        // return before every claimed chunk is done.
+        auto work = [loop, &f, begin, end, chunk, chunks]{
+            for (size_t c; (c = loop->next.fetch_add(1, std::memory_order_relaxed)) < chunks; ){
+                const size_t lo = begin + c*chunk, hi = std::min(end, lo + chunk);
+                for (size_t i=lo; i<hi; ++i) f(i);
+                loop->done.fetch_add(1, std::memory_order_release);
+            }
+        };
+        for (size_t c=1; c<chunks; ++c) post(work);
+        work();
+        const bool worker = currentPool == this;
+        while (loop->done.load(std::memory_order_acquire) < chunks)
+            if (!worker || !runPendingTask()) std::this_thread::yield();
+    }
+
+    // Answers every query with solve(query) on the workers, `kBatchChunk`
+    // queries per task. onResult(index, result) is called on the worker as
+    // each answer is ready; the future delivers all of them in query order
+    // once the last one is in. solve must be safe to call concurrently
+    // (engines keep their scratch in per-thread contexts).
+    template<class Query, class Solve, class Callback>
+    auto submitBatch(std::vector<Query> queries, Solve solve, Callback onResult)
+        -> std::future<std::vector<std::invoke_result_t<Solve&, const Query&>>> {
+        using R = std::invoke_result_t<Solve&, const Query&>;
+        struct Batch {
+            Batch(std::vector<Query> q, Solve s, Callback c, size_t chunks)
+                : queries(std::move(q)), results(queries.size()), solve(std::move(s)), onResult(std::move(c)), chunksLeft(chunks) {}
+            std::vector<Query> queries;
+            std::vector<R> results;
+            Solve solve;
+            Callback onResult;
+            std::atomic<size_t> chunksLeft;
+            std::promise<std::vector<R>> done;
+        };
+        const size_t chunks = (queries.size() + kBatchChunk - 1) / kBatchChunk;
+        auto batch = std::make_shared<Batch>(std::move(queries), std::move(solve), std::move(onResult), chunks);
+        auto result = batch->done.get_future();
+        if (chunks == 0){ batch->done.set_value({}); return result; }
+
+        for (size_t c=0; c<chunks; ++c){
+            post([batch, c]{
+                const size_t lo = c*kBatchChunk, hi = std::min(batch->queries.size(), lo + kBatchChunk);
+                for (size_t i=lo; i<hi; ++i){
+                    batch->results[i] = batch->solve(batch->queries[i]);
+                    batch->onResult(i, batch->results[i]);
+                }
+                if (batch->chunksLeft.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                    batch->done.set_value(std::move(batch->results));
+            });
+        }
+        return result;
+    }
+
+    template<class Query, class Solve>
+    auto submitBatch(std::vector<Query> queries, Solve solve){
+        using R = std::invoke_result_t<Solve&, const Query&>;
+        return submitBatch(std::move(queries), std::move(solve), [](size_t, const R&){});
+    }
+
+private:
+    static constexpr size_t kBatchChunk = 64;
+
+    struct Queue {
+        std::mutex lock;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    // Own deque from the back (most recent, still in cache), then the other
+    // deques from the front (oldest, most likely the largest pieces of work).
+    bool take(std::function<void()>& task){
+        if (queued.load(std::memory_order_relaxed) == 0) return false;
+        const bool own = currentPool == this;
+        const size_t n = queues.size(), first = own ? currentWorker : nextQueue.load(std::memory_order_relaxed) % n;
+        for (size_t k=0; k<n; ++k){
+            Queue& q = *queues[(first + k) % n];
+            std::lock_guard<std::mutex> lk(q.lock);
+            if (q.tasks.empty()) continue;
+            if (own && k == 0){ task = std::move(q.tasks.back()); q.tasks.pop_back(); }
+            else { task = std::move(q.tasks.front()); q.tasks.pop_front(); }
+            queued.fetch_sub(1);
+            return true;
+        }
+        return false;
+    }
+
+    void workerLoop(unsigned index){
+        currentPool = this;
+        currentWorker = index;
+        std::function<void()> task;
+        for (;;){
+            if (take(task)){ task(); task = nullptr; continue; }
+            std::unique_lock<std::mutex> lk(sleepLock);
+            sleepers.fetch_add(1);
+            wake.wait(lk, [&]{ return queued.load() > 0 || stopping; });
+            sleepers.fetch_sub(1);
+            if (stopping && queued.load() == 0) return;
+        }
+    }
+
+    std::vector<std::unique_ptr<Queue>> queues; // one per worker
+    std::vector<std::thread> threads;
+    std::atomic<size_t> queued{0};     // tasks across all deques
+    std::atomic<size_t> nextQueue{0};  // round-robin target for outside submissions
+    std::atomic<unsigned> sleepers{0};
+    std::mutex sleepLock;
+    std::condition_variable wake;
+    bool stopping = false;             // guarded by sleepLock
+
+    static inline thread_local const ThreadPool* currentPool = nullptr;
+    static inline thread_local size_t currentWorker = 0;
+};
+
+// One pool for the whole program: parallel loops, precomputation, batches.
+inline ThreadPool& sharedPool(){
+    static ThreadPool pool;
+    return pool;
+}
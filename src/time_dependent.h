@@ -0,0 +1,181 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+#include "graph.h"
+#include "dijkstra.h"
+
+// ---------------- Time-dependent travel times ----------------
+// A profile is a daily, periodic, piecewise-linear factor on an edge's
+// free-flow time: 1.0 = free flow, 1.8 = rush hour, and so on. Storing
+// factors instead of hours lets one profile serve every edge with the same
+// pattern. A factor's slope is scaled by the free-flow time, though, so a
+// profile that is FIFO on an edge can stop being FIFO when the edge gets
+// slower: weight updates must re-check fifo() and detach() on failure.
+//
+// Storage is kept small:
+//  - breakpoint times (hours of the day) live in shared sets, so profiles
+//    with the same shape reference one array;
+//  - factors are quantized to 16 bits between each profile's min and max;
+//  - an edge costs one 32-bit profile id (kNone = static).
+class TravelTimeProfiles {
+public:
+    static constexpr uint32_t kNone = ~0u;
+    static constexpr double kDayHours = 24.0;
+
+    // Ascending hours of the day in [0, 24); returns the set's id. An
+    // identical set already stored is reused.
+    uint32_t addBreakpoints(const std::vector<float>& hours){
+        for (uint32_t id=0; id+1<breakpointOffsets.size(); ++id){
+            if (breakpointOffsets[id+1]-breakpointOffsets[id] == hours.size() &&
+                std::equal(hours.begin(), hours.end(), breakpointTimes.begin()+breakpointOffsets[id])) return id;
+        }
+        if (breakpointOffsets.empty()) breakpointOffsets.push_back(0);
+        breakpointTimes.insert(breakpointTimes.end(), hours.begin(), hours.end());
+        breakpointOffsets.push_back((uint32_t)breakpointTimes.size());
+        return (uint32_t)breakpointOffsets.size()-2;
+    }
+
+    // One factor per breakpoint of `breakpoints`; returns the profile's id.
+    uint32_t addProfile(uint32_t breakpoints, const std::vector<double>& factors){
+        Profile p;
+        p.breakpoints = breakpoints;
+        p.firstValue = (uint32_t)values.size();
+        const double lo = *std::min_element(factors.begin(), factors.end());
+        const double hi = *std::max_element(factors.begin(), factors.end());
+        p.base = (float)lo;
+        p.step = (float)((hi - lo) / 65535.0);
+        for (double f : factors)
+            values.push_back(p.step > 0.0f ? (uint16_t)std::lround((f - lo) / p.step) : 0);
+        profiles.push_back(p);
+        return (uint32_t)profiles.size()-1;
+    }
+
+    // True if `profile` on an edge of `freeFlowHours` never lets the travel
+    // time fall faster than the clock runs: departing later must never mean
+    // arriving earlier (FIFO), or time-dependent Dijkstra stops being exact.
+    bool fifo(uint32_t profile, double freeFlowHours) const {
+        const Profile& p = profiles[profile];
+        const uint32_t m = numBreakpoints(p);
+        for (uint32_t i=0; i<m; ++i){
+            double t0 = breakpointHour(p, i), t1 = i+1<m ? breakpointHour(p, i+1) : breakpointHour(p, 0) + kDayHours;
+            double slope = (value(p, (i+1)%m) - value(p, i)) * freeFlowHours / std::max(t1 - t0, 1e-9);
+            if (slope < -1.0) return false;
+        }
+        return true;
+    }
+
+    // Attaches `profile` to edge e. Refused (false) unless it is FIFO there.
+    bool assign(CsrGraph::EdgeId e, uint32_t profile, double freeFlowHours){
+        if (!fifo(profile, freeFlowHours)) return false;
+        if (edgeProfiles.size() <= e) edgeProfiles.resize(e+1, kNone);
+        edgeProfiles[e] = profile;
+        return true;
+    }
+
+    // Makes edge e static again.
+    void detach(CsrGraph::EdgeId e){ if (e < edgeProfiles.size()) edgeProfiles[e] = kNone; }
+
+    bool empty() const { return profiles.empty(); }
+    uint32_t profileOf(CsrGraph::EdgeId e) const { return e < edgeProfiles.size() ? edgeProfiles[e] : kNone; }
+    size_t sizeBytes() const {
+        return breakpointTimes.size()*sizeof(float) + breakpointOffsets.size()*sizeof(uint32_t)
+             + values.size()*sizeof(uint16_t) + profiles.size()*sizeof(Profile) + edgeProfiles.size()*sizeof(uint32_t);
+    }
+
+    // Factor at `hour` (any real number; the profile repeats every day).
+    double factorAt(uint32_t profile, double hour) const {
+        const Profile& p = profiles[profile];
+        const uint32_t m = numBreakpoints(p);
+        double t = std::fmod(hour, kDayHours);
+        if (t < 0.0) t += kDayHours;
+        const float* first = &breakpointTimes[breakpointOffsets[p.breakpoints]];
+        uint32_t i = (uint32_t)(std::upper_bound(first, first+m, (float)t) - first); // first breakpoint after t
+        // Segment [i-1, i], wrapping around midnight at both ends.
+        uint32_t a = i == 0 ? m-1 : i-1, b = i == m ? 0 : i;
+        double ta = first[a], tb = first[b];
+        if (i == 0) ta -= kDayHours;
+        if (i == m) tb += kDayHours;
+        double va = value(p, a), vb = value(p, b);
+        return tb > ta ? va + (vb - va) * (t - ta) / (tb - ta) : va;
+    }
+
+    // Hours to traverse e when entering it at `departure` (hours).
+    double travelTime(CsrGraph::EdgeId e, double departure, double freeFlowHours) const {
+        uint32_t p = profileOf(e);
+        return p == kNone ? freeFlowHours : freeFlowHours * factorAt(p, departure);
+    }
+
+    // Smallest factor the edge ever sees; pieces are linear, so it sits at a
+    // breakpoint and the quantized minimum is exactly the profile's base.
+    double minFactor(CsrGraph::EdgeId e) const {
+        uint32_t p = profileOf(e);
+        return p == kNone ? 1.0 : (double)profiles[p].base;
+    }
+
+private:
+    struct Profile {
+        uint32_t breakpoints; // breakpoint set id
+        uint32_t firstValue;  // index into values, one per breakpoint
+        float base, step;     // factor = base + step * value
+    };
+
+    uint32_t numBreakpoints(const Profile& p) const {
+        return breakpointOffsets[p.breakpoints+1] - breakpointOffsets[p.breakpoints];
+    }
+    double breakpointHour(const Profile& p, uint32_t i) const {
+        return breakpointTimes[breakpointOffsets[p.breakpoints] + i];
+    }
+    double value(const Profile& p, uint32_t i) const {
+        return (double)p.base + (double)p.step * values[p.firstValue + i];
+    }
+
+    std::vector<float>    breakpointTimes;   // all sets back to back
+    std::vector<uint32_t> breakpointOffsets; // set s is [offsets[s], offsets[s+1])
+    std::vector<uint16_t> values;            // quantized factors
+    std::vector<Profile>  profiles;
+    std::vector<uint32_t> edgeProfiles;      // per EdgeId, kNone = static
+};
+
+// Per-edge lower bound on the travel time, for A* potentials.
+inline std::vector<double> minTravelTimes(const TravelTimeProfiles& profiles, const std::vector<double>& freeFlowHours){
+    std::vector<double> out(freeFlowHours.size());
+    for (CsrGraph::EdgeId e=0; e<out.size(); ++e) out[e] = freeFlowHours[e] * profiles.minFactor(e);
+    return out;
+}
+
+// Time-dependent A*: labels are hours since `departure`, and an arc's cost
+// is evaluated at the moment the route reaches its tail. With FIFO profiles
+// the earliest arrival at a node is also the best moment to leave it, so the
+// usual label-setting argument holds. `pot` must be a consistent lower bound
+// on the remaining time (e.g. Euclidean over minTravelTimes).
+template<class Potential>
+double timeDependentAstar(const CsrGraph& g, const TravelTimeProfiles& profiles, const std::vector<double>& freeFlowHours,
+                          int source, int target, double departure, QueryContext& ctx, const Potential& pot){
+    ctx.reset(g.numNodes());
+    ctx.setLabel(source, 0.0, -1);
+    ctx.push(pot(source), source);
+
+    while (!ctx.empty()){
+        auto [key, u] = ctx.pop();
+        const double d = ctx.dist(u);
+        if (key > d + pot(u)) continue; // stale entry
+        ++ctx.stats.settled;
+        if (u == target) return d;
+        for (auto a=g.arcBegin(u); a<g.arcEnd(u); ++a){
+            ++ctx.stats.relaxed;
+            const CsrGraph::EdgeId e = g.arcEdge(a);
+            const int v = (int)g.arcTarget(a);
+            double nd = d + profiles.travelTime(e, departure + d, freeFlowHours[e]);
+            if (nd < ctx.dist(v)){
+                ctx.setLabel(v, nd, u);
+                ctx.push(nd + pot(v), v);
+            }
+        }
+    }
+    return target >= 0 ? ctx.dist(target) : QueryContext::kInf;
+}
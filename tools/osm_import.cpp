@@ -0,0 +1,480 @@
+// OpenStreetMap PBF -> Pathfinder network (data/nodes.csv, data/edges.csv).
+//
+//   g++ -std=c++17 -O2 -pthread tools/osm_import.cpp -lz -o osm_import
+//   ./osm_import bangladesh-latest.osm.pbf [data] [--geometry]
+//
+// Two streaming passes over the file, blocks decoded in parallel:
+//  1. ways: keep drivable highways, remember their node lists and speeds;
+//     a node becomes a graph node if it ends a way or is shared by two.
+//  2. nodes: coordinates of every node those ways use.
+// Each way is then cut at its graph nodes into edges whose length (km) is
+// summed over the intermediate points, which are dropped from the graph (or
+// kept per edge in geometry.csv with --geometry). Only the compressed blocks
+// of one batch, the way node lists and the needed coordinates are in memory.
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <iomanip>
+#include <chrono>
+
+#include <zlib.h>
+
+#include "../src/thread_pool.h"
+
+// ---------------- Protocol buffer wire format ----------------
+// Just enough to walk the OSM messages: varints, zigzag, length-delimited
+// fields and packed arrays.
+struct PbfReader {
+    const uint8_t* p;
+    const uint8_t* end;
+    uint32_t field = 0, wireType = 0;
+    bool ok = true;
+
+    PbfReader(const uint8_t* b, size_t n) : p(b), end(b + n) {}
+    explicit PbfReader(const std::string& s) : p((const uint8_t*)s.data()), end(p + s.size()) {}
+
+    uint64_t varint(){
+        uint64_t v = 0;
+        for (int shift=0; shift<64; shift+=7){
+            if (p >= end){ ok = false; return 0; }
+            uint8_t b = *p++;
+            v |= (uint64_t)(b & 0x7f) << shift;
+            if (!(b & 0x80)) return v;
+        }
+        ok = false;
+        return v;
+    }
+    static int64_t zigzag(uint64_t v){ return (int64_t)(v >> 1) ^ -(int64_t)(v & 1); }
+
+    // Advances to the next field; false at the end or on malformed input.
+    bool next(){
+        if (!ok || p >= end) return false;
+        uint64_t key = varint();
+        field = (uint32_t)(key >> 3);
+        wireType = (uint32_t)(key & 7);
+        return ok;
+    }
+    PbfReader bytes(){
+        uint64_t n = varint();
+        if (!ok || n > (uint64_t)(end - p)){ ok = false; return PbfReader(end, 0); }
+        PbfReader sub(p, (size_t)n);
+        p += n;
+        return sub;
+    }
+    std::string string(){ PbfReader b = bytes(); return std::string((const char*)b.p, (size_t)(b.end - b.p)); }
+    void skip(){
+        switch (wireType){
+            case 0: varint(); break;
+            case 1: p += 8; break;
+            case 2: bytes(); break;
+            case 5: p += 4; break;
+            default: ok = false;
+        }
+        if (p > end) ok = false;
+    }
+};
+
+// ---------------- File blocks ----------------
+// [4-byte big-endian header size][BlobHeader][Blob], repeated.
+struct RawBlock {
+    std::string type;  // "OSMHeader" or "OSMData"
+    std::string blob;  // still compressed
+};
+
+static bool readBlock(std::FILE* f, RawBlock& out, std::string& error){
+    uint8_t size[4];
+    if (std::fread(size, 1, 4, f) != 4) return false; // clean end of file
+    uint32_t headerSize = (uint32_t)size[0] << 24 | (uint32_t)size[1] << 16 | (uint32_t)size[2] << 8 | size[3];
+    if (headerSize > (64u << 10)){ error = "blob header too large"; return false; }
+    std::string header(headerSize, '\0');
+    if (std::fread(&header[0], 1, headerSize, f) != headerSize){ error = "truncated blob header"; return false; }
+    PbfReader h(header);
+    uint64_t dataSize = 0;
+    out.type.clear();
+    while (h.next()){
+        if (h.field == 1 && h.wireType == 2) out.type = h.string();
+        else if (h.field == 3 && h.wireType == 0) dataSize = h.varint();
+        else h.skip();
+    }
+    if (!h.ok || dataSize > (64u << 20)){ error = "bad blob header"; return false; }
+    out.blob.resize((size_t)dataSize);
+    if (std::fread(&out.blob[0], 1, (size_t)dataSize, f) != dataSize){ error = "truncated blob"; return false; }
+    return true;
+}
+
+// Blob -> uncompressed message (raw or zlib; other codecs are refused).
+static bool unpack(const std::string& blob, std::string& out){
+    PbfReader b(blob);
+    std::string raw, zlibData;
+    uint64_t rawSize = 0;
+    while (b.next()){
+        if (b.field == 1 && b.wireType == 2) raw = b.string();
+        else if (b.field == 2 && b.wireType == 0) rawSize = b.varint();
+        else if (b.field == 3 && b.wireType == 2) zlibData = b.string();
+        else if (b.field >= 4 && b.wireType == 2) return false; // lzma, bzip2, lz4, zstd
+        else b.skip();
+    }
+    if (!b.ok) return false;
+    if (!zlibData.empty()){
+        if (rawSize > (64u << 20)) return false;
+        out.resize((size_t)rawSize);
+        uLongf n = (uLongf)rawSize;
+        if (uncompress((Bytef*)&out[0], &n, (const Bytef*)zlibData.data(), (uLong)zlibData.size()) != Z_OK || n != rawSize) return false;
+        return true;
+    }
+    out = std::move(raw);
+    return true;
+}
+
+// ---------------- Primitive blocks ----------------
+struct BlockFrame {
+    std::vector<std::string> strings;
+    int64_t granularity = 100, latOffset = 0, lonOffset = 0;
+    std::vector<PbfReader> groups;
+};
+
+static bool readFrame(const std::string& data, BlockFrame& frame){
+    PbfReader r(data);
+    while (r.next()){
+        if (r.field == 1 && r.wireType == 2){
+            PbfReader st = r.bytes();
+            while (st.next()){
+                if (st.field == 1 && st.wireType == 2) frame.strings.push_back(st.string());
+                else st.skip();
+            }
+            if (!st.ok) return false;
+        }
+        else if (r.field == 2 && r.wireType == 2) frame.groups.push_back(r.bytes());
+        else if (r.field == 17 && r.wireType == 0) frame.granularity = (int64_t)r.varint();
+        else if (r.field == 19 && r.wireType == 0) frame.latOffset = (int64_t)r.varint();
+        else if (r.field == 20 && r.wireType == 0) frame.lonOffset = (int64_t)r.varint();
+        else r.skip();
+    }
+    return r.ok;
+}
+
+// Calls f(value) for every element of a packed varint field.
+template<class F>
+static bool forEachPacked(PbfReader& r, F&& f){
+    if (r.wireType != 2){ f(r.varint()); return r.ok; }
+    PbfReader packed = r.bytes();
+    while (packed.ok && packed.p < packed.end) f(packed.varint());
+    return packed.ok && r.ok;
+}
+
+// ---------------- Pass 1: ways ----------------
+struct Way {
+    float speed;                 // km/h
+    uint32_t firstRef, numRefs;  // into the block's refs
+};
+struct WayBlock {
+    std::vector<Way> ways;
+    std::vector<int64_t> refs;
+};
+
+// Drivable highway classes and their default speeds (km/h).
+static float highwaySpeed(const std::string& v){
+    static const std::pair<const char*, float> kSpeeds[] = {
+        {"motorway", 80}, {"trunk", 65}, {"primary", 55}, {"secondary", 45}, {"tertiary", 35},
+        {"unclassified", 25}, {"residential", 20}, {"living_street", 10}, {"service", 15}, {"road", 25},
+        {"motorway_link", 60}, {"trunk_link", 50}, {"primary_link", 45}, {"secondary_link", 35}, {"tertiary_link", 30},
+    };
+    for (const auto& [name, speed] : kSpeeds) if (v == name) return speed;
+    return 0.0f;
+}
+
+// maxspeed in km/h ("50", "30 mph"); 0 when absent or unreadable.
+static float maxSpeed(const std::string& v){
+    float s = 0.0f;
+    size_t i = 0;
+    for (; i<v.size() && v[i]>='0' && v[i]<='9'; ++i) s = s*10.0f + (float)(v[i]-'0');
+    if (v.find("mph") != std::string::npos) s *= 1.609f;
+    return s;
+}
+
+static bool decodeWays(const std::string& data, WayBlock& out){
+    BlockFrame frame;
+    if (!readFrame(data, frame)) return false;
+    for (PbfReader group : frame.groups){
+        while (group.next()){
+            if (group.field != 3 || group.wireType != 2){ group.skip(); continue; }
+            PbfReader w = group.bytes();
+            std::vector<uint32_t> keys, vals;
+            const uint32_t first = (uint32_t)out.refs.size();
+            while (w.next()){
+                if (w.field == 2) forEachPacked(w, [&](uint64_t v){ keys.push_back((uint32_t)v); });
+                else if (w.field == 3) forEachPacked(w, [&](uint64_t v){ vals.push_back((uint32_t)v); });
+                else if (w.field == 8){
+                    int64_t id = 0;
+                    forEachPacked(w, [&](uint64_t v){ id += PbfReader::zigzag(v); out.refs.push_back(id); });
+                }
+                else w.skip();
+            }
+            if (!w.ok || keys.size() != vals.size()) return false;
+
+            float speed = 0.0f, limit = 0.0f;
+            bool closed = false;
+            for (size_t i=0; i<keys.size(); ++i){
+                if (keys[i] >= frame.strings.size() || vals[i] >= frame.strings.size()) return false;
+                const std::string& k = frame.strings[keys[i]];
+                const std::string& v = frame.strings[vals[i]];
+                if (k == "highway") speed = highwaySpeed(v);
+                else if (k == "maxspeed") limit = maxSpeed(v);
+                else if ((k == "access" || k == "motor_vehicle") && (v == "no" || v == "private")) closed = true;
+                else if (k == "area" && v == "yes") closed = true;
+            }
+            const uint32_t count = (uint32_t)out.refs.size() - first;
+            if (speed > 0.0f && !closed && count >= 2) out.ways.push_back({limit > 0.0f ? limit : speed, first, count});
+            else out.refs.resize(first);
+        }
+        if (!group.ok) return false;
+    }
+    return true;
+}
+
+// ---------------- Pass 2: coordinates ----------------
+// Fixed point, 1e-7 degrees, as OSM stores them.
+struct LatLon { int32_t lat, lon; };
+static const LatLon kMissing{INT32_MIN, INT32_MIN};
+
+// Fills coords[i] for every needed[i] (sorted ids) that this block holds.
+static bool decodeNodes(const std::string& data, const std::vector<int64_t>& needed, std::vector<LatLon>& coords){
+    BlockFrame frame;
+    if (!readFrame(data, frame)) return false;
+    auto store = [&](int64_t id, int64_t lat, int64_t lon){
+        auto it = std::lower_bound(needed.begin(), needed.end(), id);
+        if (it == needed.end() || *it != id) return;
+        // nanodegrees -> 1e-7 degrees
+        coords[it - needed.begin()] = { (int32_t)((frame.latOffset + frame.granularity*lat) / 100),
+                                        (int32_t)((frame.lonOffset + frame.granularity*lon) / 100) };
+    };
+    for (PbfReader group : frame.groups){
+        while (group.next()){
+            if (group.field == 1 && group.wireType == 2){ // plain node
+                PbfReader n = group.bytes();
+                int64_t id = 0, lat = 0, lon = 0;
+                while (n.next()){
+                    if (n.field == 1) id = PbfReader::zigzag(n.varint());
+                    else if (n.field == 8) lat = PbfReader::zigzag(n.varint());
+                    else if (n.field == 9) lon = PbfReader::zigzag(n.varint());
+                    else n.skip();
+                }
+                if (!n.ok) return false;
+                store(id, lat, lon);
+            } else if (group.field == 2 && group.wireType == 2){ // dense nodes, delta coded
+                PbfReader d = group.bytes();
+                std::vector<int64_t> ids, lats, lons;
+                while (d.next()){
+                    std::vector<int64_t>* target = d.field == 1 ? &ids : d.field == 8 ? &lats : d.field == 9 ? &lons : nullptr;
+                    if (!target){ d.skip(); continue; }
+                    int64_t acc = 0;
+                    forEachPacked(d, [&](uint64_t v){ acc += PbfReader::zigzag(v); target->push_back(acc); });
+                }
+                if (!d.ok || ids.size() != lats.size() || ids.size() != lons.size()) return false;
+                for (size_t i=0; i<ids.size(); ++i) store(ids[i], lats[i], lons[i]);
+            } else {
+                group.skip();
+            }
+        }
+        if (!group.ok) return false;
+    }
+    return true;
+}
+
+// ---------------- Streaming driver ----------------
+// Reads batches of blocks and decodes each batch on all cores; `decode` gets
+// (position in the batch, uncompressed block) and runs concurrently, then
+// merge(batch size) runs on the caller.
+static size_t blocksPerBatch(){ return std::max<size_t>(4, (size_t)sharedPool().size() * 4); }
+
+template<class Decode, class Merge>
+static bool forEachDataBlock(const std::string& path, Decode&& decode, Merge&& merge, std::string& error){
+    std::FILE* f = std::fopen(path.c_str(), "rb");
+    if (!f){ error = path + ": cannot open"; return false; }
+    const size_t batchSize = blocksPerBatch();
+    bool more = true, failed = false;
+    while (more && !failed){
+        std::vector<RawBlock> batch;
+        RawBlock block;
+        while (batch.size() < batchSize && (more = readBlock(f, block, error))){
+            if (block.type == "OSMData") batch.push_back(std::move(block));
+        }
+        if (!error.empty()){ error = path + ": " + error; failed = true; }
+        std::vector<char> bad(batch.size(), 0);
+        sharedPool().parallelFor(0, batch.size(), [&](size_t i){
+            std::string data;
+            bad[i] = !unpack(batch[i].blob, data) || !decode(i, data);
+        }, 1);
+        for (size_t i=0; i<batch.size() && !failed; ++i)
+            if (bad[i]){ error = path + ": cannot decode a data block (only zlib or raw blocks are supported)"; failed = true; }
+        if (!failed) merge(batch.size());
+    }
+    std::fclose(f);
+    return !failed;
+}
+
+// Great-circle distance in km.
+static double haversineKm(LatLon a, LatLon b){
+    const double kDeg = 1e-7 * 3.14159265358979323846 / 180.0;
+    double la1 = a.lat*kDeg, la2 = b.lat*kDeg, dla = la2 - la1, dlo = (double)(b.lon - a.lon)*kDeg;
+    double h = std::sin(dla/2)*std::sin(dla/2) + std::cos(la1)*std::cos(la2)*std::sin(dlo/2)*std::sin(dlo/2);
+    return 2.0 * 6371.0088 * std::asin(std::min(1.0, std::sqrt(h)));
+}
+
+int main(int argc, char** argv){
+    if (argc < 2){
+        std::cout << "usage: osm_import <file.osm.pbf> [output dir, default data] [--geometry]\n";
+        return 1;
+    }
+    const std::string input = argv[1];
+    std::string outDir = "data";
+    bool geometry = false;
+    for (int i=2; i<argc; ++i){
+        if (std::string(argv[i]) == "--geometry") geometry = true;
+        else outDir = argv[i];
+    }
+    auto t0 = std::chrono::steady_clock::now();
+    auto seconds = [&]{ return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count(); };
+    std::string error;
+
+    // Pass 1: highways. Blocks keep their file order so the output is the
+    // same on every run.
+    std::vector<Way> ways;
+    std::vector<int64_t> refs;
+    std::vector<WayBlock> decoded(blocksPerBatch());
+    bool ok = forEachDataBlock(input,
+        [&](size_t i, const std::string& data){ return decodeWays(data, decoded[i]); },
+        [&](size_t n){
+            for (size_t i=0; i<n; ++i){
+                for (Way w : decoded[i].ways){ w.firstRef += (uint32_t)refs.size(); ways.push_back(w); }
+                refs.insert(refs.end(), decoded[i].refs.begin(), decoded[i].refs.end());
+                decoded[i] = WayBlock();
+            }
+        }, error);
+    if (!ok){ std::cout << error << "\n"; return 1; }
+    std::cout << "Pass 1: " << ways.size() << " highways, " << refs.size() << " node references ("
+              << std::fixed << std::setprecision(1) << seconds() << " s)\n";
+
+    // Graph nodes: way ends and nodes used more than once.
+    std::vector<int64_t> needed(refs);
+    std::sort(needed.begin(), needed.end());
+    std::vector<uint8_t> isGraphNode;
+    {
+        std::vector<int64_t> unique;
+        unique.reserve(needed.size());
+        for (size_t i=0; i<needed.size(); ){
+            size_t j = i;
+            while (j < needed.size() && needed[j] == needed[i]) ++j;
+            unique.push_back(needed[i]);
+            isGraphNode.push_back(j - i > 1);
+            i = j;
+        }
+        needed.swap(unique);
+    }
+    auto slot = [&](int64_t id){ return (size_t)(std::lower_bound(needed.begin(), needed.end(), id) - needed.begin()); };
+    for (const Way& w : ways){
+        isGraphNode[slot(refs[w.firstRef])] = 1;
+        isGraphNode[slot(refs[w.firstRef + w.numRefs - 1])] = 1;
+    }
+
+    // Pass 2: coordinates of every node a highway uses.
+    std::vector<LatLon> coords(needed.size(), kMissing);
+    ok = forEachDataBlock(input,
+        [&](size_t, const std::string& data){ return decodeNodes(data, needed, coords); },
+        [](size_t){}, error);
+    if (!ok){ std::cout << error << "\n"; return 1; }
+    size_t missing = (size_t)std::count_if(coords.begin(), coords.end(), [](LatLon c){ return c.lat == kMissing.lat; });
+    std::cout << "Pass 2: " << needed.size() - missing << " of " << needed.size() << " coordinates ("
+              << seconds() << " s)\n";
+
+    // Dense ids for graph nodes, in OSM id order.
+    std::vector<uint32_t> nodeIndex(needed.size(), ~0u);
+    std::vector<size_t> graphNodes;
+    for (size_t i=0; i<needed.size(); ++i)
+        if (isGraphNode[i] && coords[i].lat != kMissing.lat){ nodeIndex[i] = (uint32_t)graphNodes.size(); graphNodes.push_back(i); }
+
+    // Cut every way at its graph nodes. A node without coordinates (clipped
+    // extract) breaks the way there.
+    struct Edge { uint32_t from, to; double km; float speed; uint32_t firstPoint, numPoints; };
+    std::vector<Edge> edges;
+    std::vector<LatLon> points; // intermediate points per edge, for --geometry
+    for (const Way& w : ways){
+        uint32_t from = ~0u, firstPoint = (uint32_t)points.size();
+        double km = 0.0;
+        LatLon prev = kMissing;
+        for (uint32_t k=0; k<w.numRefs; ++k){
+            const size_t s = slot(refs[w.firstRef + k]);
+            const LatLon c = coords[s];
+            if (c.lat == kMissing.lat){ from = ~0u; prev = kMissing; km = 0.0; points.resize(firstPoint); continue; }
+            if (prev.lat != kMissing.lat) km += haversineKm(prev, c);
+            prev = c;
+            if (nodeIndex[s] == ~0u){ // intermediate point
+                if (from != ~0u && geometry) points.push_back(c);
+                continue;
+            }
+            if (from != ~0u && from != nodeIndex[s])
+                edges.push_back({from, nodeIndex[s], km, w.speed, firstPoint, (uint32_t)points.size() - firstPoint});
+            else
+                points.resize(firstPoint); // start of a piece, or a loop back to the same node
+            from = nodeIndex[s];
+            km = 0.0;
+            firstPoint = (uint32_t)points.size();
+        }
+        points.resize(firstPoint);
+    }
+
+    // Map coordinates: equirectangular around the mean latitude, scaled to
+    // fit the window's -0.95..0.95 square without distortion.
+    double minX = 1e300, maxX = -1e300, minY = 1e300, maxY = -1e300, meanLat = 0.0;
+    for (size_t i : graphNodes) meanLat += coords[i].lat * 1e-7;
+    if (!graphNodes.empty()) meanLat /= (double)graphNodes.size();
+    const double lonScale = std::cos(meanLat * 3.14159265358979323846 / 180.0);
+    auto project = [&](LatLon c, double& x, double& y){ x = c.lon * 1e-7 * lonScale; y = c.lat * 1e-7; };
+    for (size_t i : graphNodes){
+        double x, y;
+        project(coords[i], x, y);
+        minX = std::min(minX, x); maxX = std::max(maxX, x);
+        minY = std::min(minY, y); maxY = std::max(maxY, y);
+    }
+    const double span = std::max(std::max(maxX - minX, maxY - minY), 1e-9);
+    auto toMap = [&](LatLon c, double& x, double& y){
+        project(c, x, y);
+        x = -0.95 + 1.9 * (x - minX) / span;
+        y = -0.95 + 1.9 * (y - minY) / span;
+    };
+
+    std::ofstream nodesOut(outDir + "/nodes.csv"), edgesOut(outDir + "/edges.csv");
+    if (!nodesOut || !edgesOut){ std::cout << outDir << ": cannot write nodes.csv / edges.csv\n"; return 1; }
+    nodesOut << "# imported from " << input << "\nid,x,y,name\n" << std::setprecision(7);
+    for (size_t k=0; k<graphNodes.size(); ++k){
+        double x, y;
+        toMap(coords[graphNodes[k]], x, y);
+        nodesOut << k << ',' << x << ',' << y << ",osm " << needed[graphNodes[k]] << '\n';
+    }
+    edgesOut << "# imported from " << input << "; km, km/h\nfrom,to,weight,speed,toll\n" << std::setprecision(6);
+    for (const Edge& e : edges) edgesOut << e.from << ',' << e.to << ',' << e.km << ',' << e.speed << ",\n";
+
+    if (geometry){
+        std::ofstream geo(outDir + "/geometry.csv");
+        geo << "# map x y of the points between the ends of each edge\nedge,points\n" << std::setprecision(7);
+        for (size_t k=0; k<edges.size(); ++k){
+            if (edges[k].numPoints == 0) continue;
+            geo << k << ',';
+            for (uint32_t p=0; p<edges[k].numPoints; ++p){
+                double x, y;
+                toMap(points[edges[k].firstPoint + p], x, y);
+                geo << (p ? " " : "") << x << ' ' << y;
+            }
+            geo << '\n';
+        }
+    }
+    std::cout << "Wrote " << graphNodes.size() << " nodes and " << edges.size() << " edges to " << outDir << " ("
+              << std::setprecision(1) << seconds() << " s)\n";
+    return 0;
+}